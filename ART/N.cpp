@@ -4,8 +4,11 @@
 #include "N.h"
 #include "N4.cpp"
 #include "N16.cpp"
+#include "N32.cpp"
 #include "N48.cpp"
 #include "N256.cpp"
+#include "N65536.cpp"
+#include "Bucket.cpp"
 
 namespace ART_unsynchronized {
 
@@ -27,6 +30,10 @@ namespace ART_unsynchronized {
                 auto n = static_cast<const N16 *>(node);
                 return n->getAnyChild();
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                return n->getAnyChild();
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 return n->getAnyChild();
@@ -35,12 +42,33 @@ namespace ART_unsynchronized {
                 auto n = static_cast<const N256 *>(node);
                 return n->getAnyChild();
             }
+            case NTypes::N65536: {
+                auto n = static_cast<const N65536 *>(node);
+                return n->getAnyChild();
+            }
+            case NTypes::Bucket: {
+                auto n = static_cast<const Bucket *>(node);
+                return n->getAnyChild();
+            }
         }
         assert(false);
         __builtin_unreachable();
     }
 
-    void N::change(N *node, uint8_t key, N *val) {
+    uint32_t N::getSpan(const N *node) {
+        return node->getType() == NTypes::N65536 ? 2 : 1;
+    }
+
+    uint16_t N::getChildKey(const N *node, const Key &k, uint32_t &level) {
+        if (node->getType() == NTypes::N65536) {
+            uint16_t key = static_cast<uint16_t>(k[level] << 8 | k[level + 1]);
+            level++;
+            return key;
+        }
+        return k[level];
+    }
+
+    void N::change(N *node, uint16_t key, N *val) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
@@ -55,6 +83,11 @@ namespace ART_unsynchronized {
                 n->change(key, val);
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->change(key, val);
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 n->change(key, val);
@@ -65,13 +98,21 @@ namespace ART_unsynchronized {
                 n->change(key, val);
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                n->change(key, val);
+                return;
+            }
+            case NTypes::Bucket:
+                // a bucket only holds leaves
+                break;
         }
         assert(false);
         __builtin_unreachable();
     }
 
     template<typename curN, typename biggerN>
-    void N::insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val) {
+    void N::insertGrow(curN *n, N *parentNode, uint16_t keyParent, uint8_t key, N *val) {
         if (n->insert(key, val)) {
             // std::cout << "Inserted" << std::endl;
             return;
@@ -89,7 +130,7 @@ namespace ART_unsynchronized {
         delete n;
     }
 
-    void N::insertA(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val) {
+    void N::insertA(N *node, N *parentNode, uint16_t keyParent, uint16_t key, N *val) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
@@ -99,7 +140,12 @@ namespace ART_unsynchronized {
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                insertGrow<N16, N48>(n, parentNode, keyParent, key, val);
+                insertGrow<N16, N32>(n, parentNode, keyParent, key, val);
+                return;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                insertGrow<N32, N48>(n, parentNode, keyParent, key, val);
                 return;
             }
             case NTypes::N48: {
@@ -112,6 +158,14 @@ namespace ART_unsynchronized {
                 n->insert(key, val);
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                n->insert(key, val);
+                return;
+            }
+            case NTypes::Bucket:
+                // the tree inserts into buckets by key
+                break;
         }
         assert(false);
         __builtin_unreachable();
@@ -168,7 +222,7 @@ namespace ART_unsynchronized {
     // }
 
 
-    N *N::getChild(const uint8_t k, N *node) {
+    N *N::getChild(const uint16_t k, N *node) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
@@ -178,6 +232,10 @@ namespace ART_unsynchronized {
                 auto n = static_cast<N16 *>(node);
                 return n->getChild(k);
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                return n->getChild(k);
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 return n->getChild(k);
@@ -186,6 +244,13 @@ namespace ART_unsynchronized {
                 auto n = static_cast<N256 *>(node);
                 return n->getChild(k);
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                return n->getChild(k);
+            }
+            case NTypes::Bucket:
+                // the tree searches buckets by key
+                break;
         }
         assert(false);
         __builtin_unreachable();
@@ -206,6 +271,11 @@ namespace ART_unsynchronized {
                 n->deleteChildren();
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->deleteChildren();
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 n->deleteChildren();
@@ -216,13 +286,23 @@ namespace ART_unsynchronized {
                 n->deleteChildren();
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                n->deleteChildren();
+                return;
+            }
+            case NTypes::Bucket: {
+                auto n = static_cast<Bucket *>(node);
+                n->deleteChildren();
+                return;
+            }
         }
         assert(false);
         __builtin_unreachable();
     }
 
     template<typename curN, typename smallerN>
-    void N::removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key) {
+    void N::removeAndShrink(curN *n, N *parentNode, uint16_t keyParent, uint8_t key) {
         if (n->remove(key, parentNode == nullptr)) {
             return;
         }
@@ -237,7 +317,7 @@ namespace ART_unsynchronized {
         delete n;
     }
 
-    void N::removeA(N *node, uint8_t key, N *parentNode, uint8_t keyParent) {
+    void N::removeA(N *node, uint16_t key, N *parentNode, uint16_t keyParent) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
@@ -249,9 +329,14 @@ namespace ART_unsynchronized {
                 removeAndShrink<N16, N4>(n, parentNode, keyParent, key);
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                removeAndShrink<N32, N16>(n, parentNode, keyParent, key);
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                removeAndShrink<N48, N16>(n, parentNode, keyParent, key);
+                removeAndShrink<N48, N32>(n, parentNode, keyParent, key);
                 return;
             }
             case NTypes::N256: {
@@ -259,6 +344,14 @@ namespace ART_unsynchronized {
                 removeAndShrink<N256, N48>(n, parentNode, keyParent, key);
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                n->remove(key);
+                return;
+            }
+            case NTypes::Bucket:
+                // the tree removes from buckets by key
+                break;
         }
         assert(false);
         __builtin_unreachable();
@@ -273,6 +366,9 @@ namespace ART_unsynchronized {
     }
 
     uint32_t N::getCount() const {
+        if (type == NTypes::N65536) {
+            return static_cast<const N65536 *>(this)->spanCount;
+        }
         return count;
     }
 
@@ -305,14 +401,58 @@ namespace ART_unsynchronized {
         return (reinterpret_cast<uint64_t>(n) & (static_cast<uint64_t>(1) << 63)) == (static_cast<uint64_t>(1) << 63);
     }
 
-    N *N::setLeaf(TID tid) {
-        return reinterpret_cast<N *>(tid | (static_cast<uint64_t>(1) << 63));
+    N *N::setLeaf(TID tid, const Key &k) {
+        uint64_t value = tid;
+#ifdef ART_LEAF_FINGERPRINTS
+        assert(tid < (static_cast<uint64_t>(1) << fingerprintShift));
+        value |= static_cast<uint64_t>(k.getFingerprint()) << fingerprintShift;
+#else
+        (void) k;
+#endif
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isInline(tid)) {
+            // no room for the fingerprint
+            return reinterpret_cast<N *>(tid | (static_cast<uint64_t>(1) << 63));
+        }
+        auto cell = static_cast<uint64_t *>(allocateNodeMemory(sizeof(TID)));
+        *cell = value;
+        return ChildRef<N>::setCell(cell);
+#else
+        return reinterpret_cast<N *>(value | (static_cast<uint64_t>(1) << 63));
+#endif
     }
 
     TID N::getLeaf(const N *n) {
-        return (reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << 63) - 1));
+        uint64_t value = reinterpret_cast<uint64_t>(n);
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isCell(n)) {
+            value = *ChildRef<N>::getCell(n);
+        }
+#endif
+#ifdef ART_LEAF_FINGERPRINTS
+        return value & ((static_cast<uint64_t>(1) << fingerprintShift) - 1);
+#else
+        return value & ((static_cast<uint64_t>(1) << 63) - 1);
+#endif
     }
 
+    bool N::matchesFingerprint(const N *leaf, const Key &k) {
+#ifdef ART_LEAF_FINGERPRINTS
+        uint64_t value = reinterpret_cast<uint64_t>(leaf);
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isCell(leaf)) {
+            value = *ChildRef<N>::getCell(leaf);
+        }
+#endif
+        uint8_t fingerprint = static_cast<uint8_t>(value >> fingerprintShift);
+        // leaves without a fingerprint have to be checked
+        return fingerprint == 0 || fingerprint == k.getFingerprint();
+#else
+        (void) leaf;
+        (void) k;
+        return true;
+#endif
+    }
     std::tuple<N *, uint8_t> N::getSecondChild(N *node, const uint8_t key) {
         switch (node->getType()) {
             case NTypes::N4: {
@@ -326,8 +466,33 @@ namespace ART_unsynchronized {
         }
     }
 
+    std::size_t N::getNodeSize(const N *node) {
+        switch (node->getType()) {
+            case NTypes::N4:
+                return sizeof(N4);
+            case NTypes::N16:
+                return sizeof(N16);
+            case NTypes::N32:
+                return sizeof(N32);
+            case NTypes::N48:
+                return sizeof(N48);
+            case NTypes::N256:
+                return sizeof(N256);
+            case NTypes::N65536:
+                return sizeof(N65536);
+            case NTypes::Bucket:
+                return Bucket::getSize(static_cast<const Bucket *>(node)->getCapacity());
+        }
+        return sizeof(N);
+    }
+
     void N::deleteNode(N *node) {
         if (N::isLeaf(node)) {
+#ifdef ART_COMPRESSED_POINTERS
+            if (ChildRef<N>::isCell(node)) {
+                freeNodeMemory(ChildRef<N>::getCell(node), sizeof(TID));
+            }
+#endif
             return;
         }
         switch (node->getType()) {
@@ -341,6 +506,11 @@ namespace ART_unsynchronized {
                 delete n;
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                delete n;
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 delete n;
@@ -351,8 +521,19 @@ namespace ART_unsynchronized {
                 delete n;
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<N65536 *>(node);
+                delete n;
+                return;
+            }
+            case NTypes::Bucket: {
+                auto n = static_cast<Bucket *>(node);
+                Bucket::destroy(n);
+                return;
+            }
         }
-        delete node;
+        assert(false);
+        __builtin_unreachable();
     }
 
 
@@ -392,6 +573,11 @@ namespace ART_unsynchronized {
                 n->getChildren(start, end, children, childrenCount);
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                n->getChildren(start, end, children, childrenCount);
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 n->getChildren(start, end, children, childrenCount);
@@ -402,6 +588,16 @@ namespace ART_unsynchronized {
                 n->getChildren(start, end, children, childrenCount);
                 return;
             }
+            case NTypes::N65536: {
+                auto n = static_cast<const N65536 *>(node);
+                n->getChildren(start, end, children, childrenCount);
+                return;
+            }
+            case NTypes::Bucket: {
+                auto n = static_cast<const Bucket *>(node);
+                n->getChildren(start, end, children, childrenCount);
+                return;
+            }
         }
     }
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../Key.h"
 #include "../Epoche.h"
+#include "../NodeSearch.h"
 #include <tbb/tbb.h>
 
 using namespace ART;
@@ -28,12 +29,23 @@ namespace ART_unsynchronized {
     enum class NTypes : uint8_t {
         N4 = 0,
         N16 = 1,
-        N48 = 2,
-        N256 = 3
+        N32 = 2,
+        N48 = 3,
+        N256 = 4,
+        N65536 = 5,
+        Bucket = 6
     };
 
     static constexpr uint32_t maxStoredPrefixLength = 10;
 
+    // the most leaves a Bucket holds before it splits
+    static constexpr uint32_t maxBucketSize = 16;
+
+#ifdef ART_LEAF_FINGERPRINTS
+    // the 8 bits below the leaf bit hold the fingerprint of the key, TIDs have to fit into the bits below
+    static constexpr uint32_t fingerprintShift = 55;
+#endif
+
     using Prefix = uint8_t[maxStoredPrefixLength];
 
     class N {
@@ -65,15 +77,26 @@ namespace ART_unsynchronized {
 
         uint32_t getCount() const;
 
-        static N *getChild(const uint8_t k, N *node);
+        /**
+         * 2 for an N65536, which consumes two key bytes, 1 for the other nodes
+         */
+        static uint32_t getSpan(const N *node);
+
+        /**
+         * the key of the child of node that k continues in, the two bytes at level and level + 1 for an N65536,
+         * which increases level by one
+         */
+        static uint16_t getChildKey(const N *node, const Key &k, uint32_t &level);
 
-        static void insertA(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val);
+        static N *getChild(const uint16_t k, N *node);
+
+        static void insertA(N *node, N *parentNode, uint16_t keyParent, uint16_t key, N *val);
 
         // N* insertWithExpansion(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val);
 
-        static void change(N *node, uint8_t key, N *val);
+        static void change(N *node, uint16_t key, N *val);
 
-        static void removeA(N *node, uint8_t key, N *parentNode, uint8_t keyParent);
+        static void removeA(N *node, uint16_t key, N *parentNode, uint16_t keyParent);
 
         bool hasPrefix() const;
 
@@ -89,7 +112,17 @@ namespace ART_unsynchronized {
 
         static bool isLeaf(const N *n);
 
-        static N *setLeaf(TID tid);
+        /**
+         * with compressed pointers a TID that does not fit into a child reference is stored in a cell, the cell
+         * is freed by deleteNode
+         */
+        static N *setLeaf(TID tid, const Key &k);
+
+        /**
+         * false if the fingerprint stored with the leaf rules out that it belongs to k, always true without
+         * ART_LEAF_FINGERPRINTS
+         */
+        static bool matchesFingerprint(const N *leaf, const Key &k);
 
         static N *getAnyChild(const N *n);
 
@@ -99,18 +132,29 @@ namespace ART_unsynchronized {
 
         static void deleteNode(N *node);
 
+        static std::size_t getNodeSize(const N *node);
+
         static std::tuple<N *, uint8_t> getSecondChild(N *node, const uint8_t k);
 
         template<typename curN, typename biggerN>
-        static void insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val);
+        static void insertGrow(curN *n, N *parentNode, uint16_t keyParent, uint8_t key, N *val);
 
         template<typename curN, typename smallerN>
-        static void removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key);
+        static void removeAndShrink(curN *n, N *parentNode, uint16_t keyParent, uint8_t key);
 
         static void getChildren(const N *node, uint8_t start, uint8_t end, std::tuple<uint8_t, N *> children[],
                                 uint32_t &childrenCount);
         
         virtual bool insert(uint8_t key, N *val) = 0;
+
+        // with compressed pointers all nodes have to come from the region
+        static void *operator new(std::size_t size) {
+            return allocateNodeMemory(size);
+        }
+
+        static void operator delete(void *n, std::size_t size) {
+            freeNodeMemory(n, size);
+        }
     };
 
     class N4 : public N {
@@ -118,7 +162,7 @@ namespace ART_unsynchronized {
         //TODO
         //atomic??
         uint8_t keys[4];
-        N *children[4] = {nullptr, nullptr, nullptr, nullptr};
+        ChildRef<N> children[4] = {nullptr, nullptr, nullptr, nullptr};
 
     public:
         N4(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N4, prefix,
@@ -148,7 +192,7 @@ namespace ART_unsynchronized {
     class N16 : public N {
     public:
         uint8_t keys[16];
-        N *children[16];
+        ChildRef<N> children[16];
 
         static uint8_t flipSign(uint8_t keyByte) {
             // Flip the sign bit, enables signed SSE comparison of unsigned values, used by Node16
@@ -169,7 +213,7 @@ namespace ART_unsynchronized {
 #endif
         }
 
-        N *const *getChildPos(const uint8_t k) const;
+        const ChildRef<N> *getChildPos(const uint8_t k) const;
 
     public:
         N16(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N16, prefix,
@@ -197,9 +241,51 @@ namespace ART_unsynchronized {
                          uint32_t &childrenCount) const;
     };
 
+    class N32 : public N {
+    public:
+        uint8_t keys[32];
+        ChildRef<N> children[32];
+
+        static uint8_t flipSign(uint8_t keyByte) {
+            return keyByte ^ 128;
+        }
+
+        // the first count keys
+        uint32_t usedMask() const {
+            return static_cast<uint32_t>((static_cast<uint64_t>(1) << count) - 1);
+        }
+
+        const ChildRef<N> *getChildPos(const uint8_t k) const;
+
+    public:
+        N32(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N32, prefix,
+                                                                              prefixLength) {
+            memset(keys, 0, sizeof(keys));
+            memset(children, 0, sizeof(children));
+        }
+
+        bool insert(uint8_t key, N *n);
+
+        template<class NODE>
+        void copyTo(NODE *n) const;
+
+        void change(uint8_t key, N *val);
+
+        N *getChild(const uint8_t k) const;
+
+        bool remove(uint8_t k, bool force);
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        void getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                         uint32_t &childrenCount) const;
+    };
+
     class N48 : public N {
         uint8_t childIndex[256];
-        N *children[48];
+        ChildRef<N> children[48];
     public:
         static const uint8_t emptyMarker = 48;
 
@@ -229,12 +315,15 @@ namespace ART_unsynchronized {
     };
 
     class N256 : public N {
-        N *children[256];
+        ChildRef<N> children[256];
+        // bit i set if children[i] is not null
+        uint64_t bitmap[4];
 
     public:
         N256(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N256, prefix,
                                                                                prefixLength) {
             memset(children, '\0', sizeof(children));
+            memset(bitmap, 0, sizeof(bitmap));
         }
 
         bool insert(uint8_t key, N *val);
@@ -255,5 +344,146 @@ namespace ART_unsynchronized {
         void getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                          uint32_t &childrenCount) const;
     };
+
+    /**
+     * A node that consumes two key bytes and addresses its children directly by them, it replaces an inner node
+     * and all of its inner children where the keys are dense. Only the bulkload creates it, it neither grows nor
+     * shrinks and stays in the tree until the tree is deleted. All keys below it must have two more bytes.
+     */
+    class N65536 : public N {
+        ChildRef<N> children[65536];
+        // bit i set if children[i] is not null
+        uint64_t bitmap[1024];
+
+        // calls fn(k) in order for the children whose first key byte is between start and end
+        template<typename Fn>
+        void forEachChild(uint8_t start, uint8_t end, Fn fn) const;
+
+    public:
+        // the uint8_t count of N would wrap
+        uint32_t spanCount = 0;
+
+        N65536(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N65536, prefix,
+                                                                                 prefixLength) {
+            memset(children, '\0', sizeof(children));
+            memset(bitmap, 0, sizeof(bitmap));
+        }
+
+        bool insert(uint16_t key, N *val);
+
+        // key is the second byte of a child whose first byte is 0
+        bool insert(uint8_t key, N *val);
+
+        void change(uint16_t key, N *n);
+
+        N *getChild(const uint16_t k) const;
+
+        void remove(uint16_t k);
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        /**
+         * the children whose first key byte is between start and end with the second key byte, up to 65536
+         */
+        void getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                         uint32_t &childrenCount) const;
+    };
+
+    /**
+     * Up to maxBucketSize leaves in key order in place of the small inner nodes at the bottom of the tree, the
+     * insert creates buckets instead of an N4 for two leaves with ART_LEAF_BUCKETS. Each entry keeps the four key
+     * bytes behind the prefix of the bucket, big-endian and padded with 0, a lookup binary searches them and only
+     * loads keys they do not cover. A full bucket doubles its capacity, at maxBucketSize it splits into inner nodes
+     * over smaller buckets. A bucket starts without prefix and gets one if its parent is merged into it.
+     */
+    class Bucket : public N {
+        uint8_t capacity;
+
+        explicit Bucket(uint32_t capacity) : N(NTypes::Bucket, nullptr, 0), capacity(capacity) { }
+
+        template<typename curN>
+        static N *buildInner(N *const leaves[], const Key keys[], uint32_t count, uint32_t level,
+                             uint32_t prefixLength);
+
+    public:
+        static std::size_t getSize(uint32_t capacity);
+
+        static Bucket *create(uint32_t capacity);
+
+        static void destroy(Bucket *b);
+
+        /**
+         * the four key bytes from level on as one big-endian number, 0 behind the end of the key
+         */
+        static uint32_t getPartialKey(const Key &k, uint32_t level);
+
+        /**
+         * the subtree of count sorted leaves and their keys that all continue in the same child at level: the leaf,
+         * a bucket or inner nodes with buckets below
+         */
+        static N *build(N *const leaves[], const Key keys[], uint32_t count, uint32_t level);
+
+        uint32_t getCapacity() const;
+
+        bool isFull() const;
+
+        bool isUnderfull() const;
+
+        // capacity partial keys followed by capacity leaves
+        uint32_t *getPartialKeys();
+
+        const uint32_t *getPartialKeys() const;
+
+        ChildRef<N> *getLeaves();
+
+        const ChildRef<N> *getLeaves() const;
+
+        /**
+         * the first entry whose partial key is not smaller than partialKey
+         */
+        uint32_t lowerBound(uint32_t partialKey) const;
+
+        /**
+         * the entry k is inserted before, loads the keys of the entries with the same partial key
+         */
+        uint32_t getInsertPosition(const Key &k, uint32_t level, void (*loadKey)(TID, Key &)) const;
+
+        void insert(uint32_t pos, uint32_t partialKey, N *leaf);
+
+        /**
+         * the bucket or subtree that replaces this full bucket with the leaf of k inserted at pos, level is the level
+         * of the first prefix byte of the bucket
+         */
+        N *grow(uint32_t pos, N *leaf, const Key &k, uint32_t level, void (*loadKey)(TID, Key &)) const;
+
+        /**
+         * the bucket of half the capacity that replaces this underfull one without the entry at pos
+         */
+        Bucket *shrink(uint32_t pos) const;
+
+        // entries are inserted with their partial key
+        bool insert(uint8_t key, N *val);
+
+        /**
+         * the entry with the partial key that holds tid, getCount() if there is none
+         */
+        uint32_t find(uint32_t partialKey, TID tid) const;
+
+        void remove(uint32_t pos);
+
+        void copyTo(Bucket *b) const;
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        /**
+         * the leaves whose first partial key byte is between start and end, with that byte as key
+         */
+        void getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                         uint32_t &childrenCount) const;
+    };
 }
 #endif //ARTVERSION1_ARTVERSION_H
@@ -1,7 +1,6 @@
 #include <assert.h>
 #include <algorithm>
 #include "N.h"
-#include <emmintrin.h> // x86 SSE intrinsics
 
 namespace ART_unsynchronized {
     const uint8_t N16_shrink = 3;
@@ -11,11 +10,10 @@ namespace ART_unsynchronized {
             return false;
         }
         uint8_t keyByteFlipped = flipSign(key);
-        __m128i cmp = _mm_cmplt_epi8(_mm_set1_epi8(keyByteFlipped), _mm_loadu_si128(reinterpret_cast<__m128i *>(keys)));
-        uint16_t bitfield = _mm_movemask_epi8(cmp) & (0xFFFF >> (16 - count));
+        uint16_t bitfield = NodeSearch::greaterMask16(keys, keyByteFlipped) & (0xFFFF >> (16 - count));
         unsigned pos = bitfield ? ctz(bitfield) : count;
         memmove(keys + pos + 1, keys + pos, count - pos);
-        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(uintptr_t));
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(children[0]));
         keys[pos] = keyByteFlipped;
         children[pos] = n;
         count++;
@@ -35,21 +33,19 @@ namespace ART_unsynchronized {
         for (unsigned i = 0; i < N16_shrink; i++) {
             n->keys[i] = flipSign(keys[i]);
         }
-        memcpy(n->children, children, sizeof(uintptr_t) * N16_shrink);
+        memcpy(n->children, children, sizeof(children[0]) * N16_shrink);
     }
 
     void N16::change(uint8_t key, N *val) {
-        N **childPos = const_cast<N **>(getChildPos(key));
+        ChildRef<N> *childPos = const_cast<ChildRef<N> *>(getChildPos(key));
         // std::cout << "Key: " << static_cast<int>(key) << std::endl;
         // std::cout << "ChildPos: " << childPos << std::endl;
         assert(childPos != nullptr);
         *childPos = val;
     }
 
-    N *const *N16::getChildPos(const uint8_t k) const {
-        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(flipSign(k)),
-                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
-        unsigned bitfield = _mm_movemask_epi8(cmp) & ((1 << count) - 1);
+    const ChildRef<N> *N16::getChildPos(const uint8_t k) const {
+        unsigned bitfield = NodeSearch::equalMask16(keys, flipSign(k)) & ((1 << count) - 1);
         if (bitfield) {
             return &children[ctz(bitfield)];
         } else {
@@ -58,7 +54,7 @@ namespace ART_unsynchronized {
     }
 
     N *N16::getChild(const uint8_t k) const {
-        N *const *childPos = getChildPos(k);
+        const ChildRef<N> *childPos = getChildPos(k);
         if (childPos == nullptr) {
             return nullptr;
         } else {
@@ -70,11 +66,11 @@ namespace ART_unsynchronized {
         if (count == N16_shrink && !force) {
             return false;
         }
-        N *const *leafPlace = getChildPos(k);
+        const ChildRef<N> *leafPlace = getChildPos(k);
         assert(leafPlace != nullptr);
         std::size_t pos = leafPlace - children;
         memmove(keys + pos, keys + pos + 1, count - pos - 1);
-        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(N *));
+        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(children[0]));
         count--;
         assert(getChild(k) == nullptr);
         return true;
@@ -99,16 +95,11 @@ namespace ART_unsynchronized {
     void N16::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                           uint32_t &childrenCount) const {
         childrenCount = 0;
-        auto startPos = getChildPos(start);
-        auto endPos = getChildPos(end);
-        if (startPos == nullptr) {
-            startPos = this->children;
-        }
-        if (endPos == nullptr) {
-            endPos = this->children + (count - 1);
-        }
-        for (auto p = startPos; p <= endPos; ++p) {
-            children[childrenCount] = std::make_tuple(flipSign(keys[p - this->children]), *p);
+        // the keys are sorted, the ones in the range are consecutive
+        unsigned bitfield = NodeSearch::rangeMask16(keys, flipSign(start), flipSign(end)) & ((1 << count) - 1);
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = ctz(bitfield);
+            children[childrenCount] = std::make_tuple(flipSign(keys[pos]), this->children[pos]);
             childrenCount++;
         }
     }
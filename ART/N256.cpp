@@ -5,27 +5,26 @@
 namespace ART_unsynchronized {
 
     void N256::deleteChildren() {
-        for (uint64_t i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                N::deleteChildren(children[i]);
-                N::deleteNode(children[i]);
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this](unsigned i) {
+            N::deleteChildren(children[i]);
+            N::deleteNode(children[i]);
+            return true;
+        });
     }
 
     bool N256::insert(uint8_t key, N *val) {
         children[key] = val;
+        bitmap[key / 64] |= static_cast<uint64_t>(1) << (key % 64);
         count++;
         return true;
     }
 
     template<class NODE>
     void N256::copyTo(NODE *n) const {
-        for (int i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                n->insert(i, children[i]);
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, n](unsigned i) {
+            n->insert(i, children[i]);
+            return true;
+        });
     }
 
     void N256::change(uint8_t key, N *n) {
@@ -41,32 +40,27 @@ namespace ART_unsynchronized {
             return false;
         }
         children[k] = nullptr;
+        bitmap[k / 64] &= ~(static_cast<uint64_t>(1) << (k % 64));
         count--;
         return true;
     }
 
     N *N256::getAnyChild() const {
         N *anyChild = nullptr;
-        for (uint64_t i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                if (N::isLeaf(children[i])) {
-                    return children[i];
-                } else {
-                    anyChild = children[i];
-                }
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, &anyChild](unsigned i) {
+            anyChild = children[i];
+            return !N::isLeaf(anyChild);
+        });
         return anyChild;
     }
 
     void N256::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                            uint32_t &childrenCount) const {
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
-            if (this->children[i] != nullptr) {
-                children[childrenCount] = std::make_tuple(i, this->children[i]);
-                childrenCount++;
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, start, end, [this, children, &childrenCount](unsigned i) {
+            children[childrenCount] = std::make_tuple(i, this->children[i]);
+            childrenCount++;
+            return true;
+        });
     }
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_unsynchronized {
+
+    bool N32::insert(uint8_t key, N *n) {
+        if (count == 32) {
+            return false;
+        }
+        uint8_t keyByteFlipped = flipSign(key);
+        uint32_t bitfield = NodeSearch::greaterMask32(keys, keyByteFlipped) & usedMask();
+        unsigned pos = bitfield ? __builtin_ctz(bitfield) : count;
+        memmove(keys + pos + 1, keys + pos, count - pos);
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(children[0]));
+        keys[pos] = keyByteFlipped;
+        children[pos] = n;
+        count++;
+        return true;
+    }
+
+    template<class NODE>
+    void N32::copyTo(NODE *n) const {
+        for (unsigned i = 0; i < count; i++) {
+            n->insert(flipSign(keys[i]), children[i]);
+        }
+    }
+
+    void N32::change(uint8_t key, N *val) {
+        ChildRef<N> *childPos = const_cast<ChildRef<N> *>(getChildPos(key));
+        assert(childPos != nullptr);
+        *childPos = val;
+    }
+
+    const ChildRef<N> *N32::getChildPos(const uint8_t k) const {
+        uint32_t bitfield = NodeSearch::equalMask32(keys, flipSign(k)) & usedMask();
+        if (bitfield) {
+            return &children[__builtin_ctz(bitfield)];
+        } else {
+            return nullptr;
+        }
+    }
+
+    N *N32::getChild(const uint8_t k) const {
+        const ChildRef<N> *childPos = getChildPos(k);
+        if (childPos == nullptr) {
+            return nullptr;
+        } else {
+            return *childPos;
+        }
+    }
+
+    bool N32::remove(uint8_t k, bool force) {
+        if (count == 12 && !force) {
+            return false;
+        }
+        const ChildRef<N> *leafPlace = getChildPos(k);
+        assert(leafPlace != nullptr);
+        std::size_t pos = leafPlace - children;
+        memmove(keys + pos, keys + pos + 1, count - pos - 1);
+        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(children[0]));
+        count--;
+        assert(getChild(k) == nullptr);
+        return true;
+    }
+
+    N *N32::getAnyChild() const {
+        for (int i = 0; i < count; ++i) {
+            if (N::isLeaf(children[i])) {
+                return children[i];
+            }
+        }
+        return children[0];
+    }
+
+    void N32::deleteChildren() {
+        for (std::size_t i = 0; i < count; ++i) {
+            N::deleteChildren(children[i]);
+            N::deleteNode(children[i]);
+        }
+    }
+
+    void N32::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                          uint32_t &childrenCount) const {
+        childrenCount = 0;
+        // the keys are sorted, the ones in the range are consecutive
+        uint32_t bitfield = NodeSearch::rangeMask32(keys, flipSign(start), flipSign(end)) & usedMask();
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = __builtin_ctz(bitfield);
+            children[childrenCount] = std::make_tuple(flipSign(keys[pos]), this->children[pos]);
+            childrenCount++;
+        }
+    }
+}
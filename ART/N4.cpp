@@ -46,8 +46,10 @@ namespace ART_unsynchronized {
     }
 
     N *N4::getChild(const uint8_t k) const {
-        for (uint32_t i = 0; i < 4; ++i) {
-            if (children[i] != nullptr && keys[i] == k) {
+        // removed children leave their keys behind
+        for (uint32_t bitfield = NodeSearch::equalMask4(keys, k); bitfield != 0; bitfield &= bitfield - 1) {
+            uint32_t i = __builtin_ctz(bitfield);
+            if (children[i] != nullptr) {
                 return children[i];
             }
         }
@@ -20,8 +20,10 @@ namespace ART_unsynchronized {
 
     template<class NODE>
     void N48::copyTo(NODE *n) const {
-        for (unsigned i = 0; i < 256; i++) {
-            if (childIndex[i] != emptyMarker) {
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = 0; base < 256; base += 64) {
+            for (uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker); mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
                 n->insert(i, children[childIndex[i]]);
             }
         }
@@ -40,7 +42,7 @@ namespace ART_unsynchronized {
     }
 
     bool N48::remove(uint8_t k, bool force) {
-        if (count == 12 && !force) {
+        if (count == 24 && !force) {
             return false;
         }
         assert(childIndex[k] != emptyMarker);
@@ -53,13 +55,14 @@ namespace ART_unsynchronized {
 
     N *N48::getAnyChild() const {
         N *anyChild = nullptr;
-        for (unsigned i = 0; i < 256; i++) {
-            if (childIndex[i] != emptyMarker) {
-                if (N::isLeaf(children[childIndex[i]])) {
-                    return children[childIndex[i]];
-                } else {
-                    anyChild = children[childIndex[i]];
-                };
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = 0; base < 256; base += 64) {
+            for (uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker); mask != 0; mask &= mask - 1) {
+                N *child = children[childIndex[base + __builtin_ctzll(mask)]];
+                if (N::isLeaf(child)) {
+                    return child;
+                }
+                anyChild = child;
             }
         }
         return anyChild;
@@ -77,8 +80,17 @@ namespace ART_unsynchronized {
     void N48::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                           uint32_t &childrenCount) const {
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
-            if (this->childIndex[i] != emptyMarker) {
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = start & ~63u; base <= end; base += 64) {
+            uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker);
+            if (base < start) {
+                mask &= ~0ull << (start - base);
+            }
+            if (end < base + 63) {
+                mask &= ~0ull >> (base + 63 - end);
+            }
+            for (; mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
                 children[childrenCount] = std::make_tuple(i, this->children[this->childIndex[i]]);
                 childrenCount++;
             }
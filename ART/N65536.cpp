@@ -0,0 +1,70 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_unsynchronized {
+
+    template<typename Fn>
+    void N65536::forEachChild(uint8_t start, uint8_t end, Fn fn) const {
+        // four bitmap words per first key byte
+        for (uint32_t w = start * 4u; w < (end + 1u) * 4u; ++w) {
+            for (uint64_t mask = bitmap[w]; mask != 0; mask &= mask - 1) {
+                if (!fn(static_cast<uint16_t>(w * 64 + __builtin_ctzll(mask)))) {
+                    return;
+                }
+            }
+        }
+    }
+
+    void N65536::deleteChildren() {
+        forEachChild(0, 255, [this](uint16_t k) {
+            N::deleteChildren(children[k]);
+            N::deleteNode(children[k]);
+            return true;
+        });
+    }
+
+    bool N65536::insert(uint16_t key, N *val) {
+        children[key] = val;
+        bitmap[key / 64] |= static_cast<uint64_t>(1) << (key % 64);
+        spanCount++;
+        return true;
+    }
+
+    bool N65536::insert(uint8_t key, N *val) {
+        return insert(static_cast<uint16_t>(key), val);
+    }
+
+    void N65536::change(uint16_t key, N *n) {
+        children[key] = n;
+    }
+
+    N *N65536::getChild(const uint16_t k) const {
+        return children[k];
+    }
+
+    void N65536::remove(uint16_t k) {
+        children[k] = nullptr;
+        bitmap[k / 64] &= ~(static_cast<uint64_t>(1) << (k % 64));
+        spanCount--;
+    }
+
+    N *N65536::getAnyChild() const {
+        N *anyChild = nullptr;
+        forEachChild(0, 255, [this, &anyChild](uint16_t k) {
+            anyChild = children[k];
+            return !N::isLeaf(anyChild);
+        });
+        return anyChild;
+    }
+
+    void N65536::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                             uint32_t &childrenCount) const {
+        childrenCount = 0;
+        forEachChild(start, end, [this, children, &childrenCount](uint16_t k) {
+            children[childrenCount] = std::make_tuple(static_cast<uint8_t>(k), this->children[k]);
+            childrenCount++;
+            return true;
+        });
+    }
+}
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <algorithm>
+#include <bitset>
 #include <iostream>
 #include "Tree.h"
 #include "../Epoche.cpp"
@@ -31,11 +32,14 @@ namespace ART_unsynchronized {
                     optimisticPrefixMatch = true;
                     // fallthrough
                 case CheckPrefixResult::Match:
-                    if (k.getKeyLen() <= level) {
+                    if (k.getKeyLen() < level + N::getSpan(node)) {
                         // std::cout << "Match" << std::endl;
                         return 0;
                     }
-                    nextNode = N::getChild(k[level], node);
+                    if (node->getType() == NTypes::Bucket) {
+                        return lookupBucket(static_cast<const Bucket *>(node), k, level, optimisticPrefixMatch);
+                    }
+                    nextNode = N::getChild(N::getChildKey(node, k, level), node);
 
                     if (nextNode == nullptr) {
                         // std::cout << "NoMatch" << std::endl;
@@ -44,7 +48,8 @@ namespace ART_unsynchronized {
                     if (N::isLeaf(nextNode)) {
                         TID tid = N::getLeaf(nextNode);
                         if (level < k.getKeyLen() - 1 || optimisticPrefixMatch) {
-                            return checkKey(tid, k);
+                            // a mismatching fingerprint saves loading the key
+                            return N::matchesFingerprint(nextNode, k) ? checkKey(tid, k) : 0;
                         }
                         // std::cout << "Match" << std::endl;
                         return tid;
@@ -267,6 +272,22 @@ namespace ART_unsynchronized {
     }
 
 
+    TID Tree::lookupBucket(const Bucket *b, const Key &k, uint32_t level, bool optimisticPrefixMatch) const {
+        uint32_t partialKey = Bucket::getPartialKey(k, level);
+        // the partial key holds the rest of k, equal entries have the same key
+        bool covered = !optimisticPrefixMatch && k.getKeyLen() <= level + sizeof(partialKey);
+        for (uint32_t i = b->lowerBound(partialKey); i < b->getCount() && b->getPartialKeys()[i] == partialKey; ++i) {
+            N *leaf = b->getLeaves()[i];
+            if (covered) {
+                return N::getLeaf(leaf);
+            }
+            if (N::matchesFingerprint(leaf, k) && checkKey(N::getLeaf(leaf), k) != 0) {
+                return N::getLeaf(leaf);
+            }
+        }
+        return 0;
+    }
+
     TID Tree::checkKey(const TID tid, const Key &k) const {
         Key kt;
         this->loadKey(tid, kt);
@@ -280,7 +301,7 @@ namespace ART_unsynchronized {
         N *node = nullptr;
         N *nextNode = root;
         N *parentNode = nullptr;
-        uint8_t parentKey, nodeKey = 0;
+        uint16_t parentKey, nodeKey = 0;
         uint32_t level = 0;
 
         while (true) {
@@ -300,7 +321,7 @@ namespace ART_unsynchronized {
                     auto newNode = new N4(node->getPrefix(), nextLevel - level);
 
                     // 2)  add node and (tid, *k) as children
-                    newNode->insert(k[nextLevel], N::setLeaf(tid));
+                    newNode->insert(k[nextLevel], N::setLeaf(tid, k));
                     newNode->insert(nonMatchingKey, node);
 
                     // 3) update parentNode to point to the new node
@@ -315,13 +336,24 @@ namespace ART_unsynchronized {
                 case CheckPrefixPessimisticResult::Match:
                     break;
             }
-            assert(nextLevel < k.getKeyLen()); //prevent duplicate key
+            assert(nextLevel + N::getSpan(node) <= k.getKeyLen()); //prevent duplicate key
+            if (node->getType() == NTypes::Bucket) {
+                auto b = static_cast<Bucket *>(node);
+                uint32_t pos = b->getInsertPosition(k, nextLevel, loadKey);
+                if (!b->isFull()) {
+                    b->insert(pos, Bucket::getPartialKey(k, nextLevel), N::setLeaf(tid, k));
+                    return;
+                }
+                N::change(parentNode, parentKey, b->grow(pos, N::setLeaf(tid, k), k, level, loadKey));
+                Bucket::destroy(b);
+                return;
+            }
             level = nextLevel;
-            nodeKey = k[level];
+            nodeKey = N::getChildKey(node, k, level);
             nextNode = N::getChild(nodeKey, node);
 
             if (nextNode == nullptr) {
-                N::insertA(node, parentNode, parentKey, nodeKey, N::setLeaf(tid));
+                N::insertA(node, parentNode, parentKey, nodeKey, N::setLeaf(tid, k));
                 return;
             }
             if (N::isLeaf(nextNode)) {
@@ -330,15 +362,25 @@ namespace ART_unsynchronized {
 
                 level++;
                 assert(level < key.getKeyLen()); //prevent inserting when prefix of key exists already
+#ifdef ART_LEAF_BUCKETS
+                N *leaves[2] = {N::setLeaf(tid, k), nextNode};
+                Key keys[2] = {k, key};
+                if (key < k) {
+                    std::swap(leaves[0], leaves[1]);
+                    std::swap(keys[0], keys[1]);
+                }
+                N::change(node, nodeKey, Bucket::build(leaves, keys, 2, level));
+                return;
+#endif
                 uint32_t prefixLength = 0;
                 while (key[level + prefixLength] == k[level + prefixLength]) {
                     prefixLength++;
                 }
 
                 auto n4 = new N4(&k[level], prefixLength);
-                n4->insert(k[level + prefixLength], N::setLeaf(tid));
+                n4->insert(k[level + prefixLength], N::setLeaf(tid, k));
                 n4->insert(key[level + prefixLength], nextNode);
-                N::change(node, k[level - 1], n4);
+                N::change(node, nodeKey, n4);
                 return;
             }
 
@@ -350,7 +392,7 @@ namespace ART_unsynchronized {
         N *node = nullptr;
         N *nextNode = root;
         N *parentNode = nullptr;
-        uint8_t parentKey, nodeKey = 0;
+        uint16_t parentKey, nodeKey = 0;
         uint32_t level = 0;
         //bool optimisticPrefixMatch = false;
 
@@ -365,7 +407,11 @@ namespace ART_unsynchronized {
                 case CheckPrefixResult::OptimisticMatch:
                     // fallthrough
                 case CheckPrefixResult::Match: {
-                    nodeKey = k[level];
+                    if (node->getType() == NTypes::Bucket) {
+                        removeFromBucket(static_cast<Bucket *>(node), parentNode, parentKey, k, level, tid);
+                        return;
+                    }
+                    nodeKey = N::getChildKey(node, k, level);
                     nextNode = N::getChild(nodeKey, node);
 
                     if (nextNode == nullptr) {
@@ -375,8 +421,9 @@ namespace ART_unsynchronized {
                         if (N::getLeaf(nextNode) != tid) {
                             return;
                         }
-                        assert(parentNode == nullptr || node->getCount() != 1);
-                        if (node->getCount() == 2 && node != root) {
+                        assert(parentNode == nullptr || node->getCount() != 1 || N::getSpan(node) == 2);
+                        // an N65536 is not replaced by its last child
+                        if (node->getCount() == 2 && node != root && N::getSpan(node) == 1) {
                             // 1. check remaining entries
                             N *secondNodeN;
                             uint8_t secondNodeK;
@@ -386,17 +433,19 @@ namespace ART_unsynchronized {
                                 //N::remove(node, k[level]); not necessary
                                 N::change(parentNode, parentKey, secondNodeN);
 
-                                delete node;
+                                N::deleteNode(node);
                             } else {
                                 //N::remove(node, k[level]); not necessary
                                 N::change(parentNode, parentKey, secondNodeN);
                                 secondNodeN->addPrefixBefore(node, secondNodeK);
 
-                                delete node;
+                                N::deleteNode(node);
                             }
                         } else {
-                            N::removeA(node, k[level], parentNode, parentKey);
+                            N::removeA(node, nodeKey, parentNode, parentKey);
                         }
+                        // frees the cell of a compressed leaf
+                        N::deleteNode(nextNode);
                         return;
                     }
                     level++;
@@ -406,16 +455,36 @@ namespace ART_unsynchronized {
     }
 
 
+    void Tree::removeFromBucket(Bucket *b, N *parentNode, uint16_t parentKey, const Key &k, uint32_t level,
+                                TID tid) {
+        uint32_t pos = b->find(Bucket::getPartialKey(k, level), tid);
+        if (pos == b->getCount()) {
+            return;
+        }
+        N *leaf = b->getLeaves()[pos];
+        if (b->getCount() == 2) {
+            // the last leaf takes the place of the bucket
+            N::change(parentNode, parentKey, b->getLeaves()[1 - pos]);
+            Bucket::destroy(b);
+        } else if (b->isUnderfull()) {
+            N::change(parentNode, parentKey, b->shrink(pos));
+            Bucket::destroy(b);
+        } else {
+            b->remove(pos);
+        }
+        N::deleteNode(leaf);
+    }
+
     inline typename Tree::CheckPrefixResult Tree::checkPrefix(N *n, const Key &k, uint32_t &level) {
         if (k.getKeyLen() <= level + n->getPrefixLength()) {
             return CheckPrefixResult::NoMatch;
         }
         if (n->hasPrefix()) {
-            for (uint32_t i = 0; i < std::min(n->getPrefixLength(), maxStoredPrefixLength); ++i) {
-                if (n->getPrefix()[i] != k[level]) {
-                    return CheckPrefixResult::NoMatch;
-                }
-                ++level;
+            uint32_t stored = std::min(n->getPrefixLength(), maxStoredPrefixLength);
+            uint32_t matching = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, stored);
+            level += matching;
+            if (matching != stored) {
+                return CheckPrefixResult::NoMatch;
             }
             if (n->getPrefixLength() > maxStoredPrefixLength) {
                 level += n->getPrefixLength() - maxStoredPrefixLength;
@@ -431,30 +500,33 @@ namespace ART_unsynchronized {
                                                                         LoadKeyFunction loadKey) {
         if (n->hasPrefix()) {
             uint32_t prevLevel = level;
+            uint32_t length = n->getPrefixLength();
+            uint32_t stored = std::min(length, maxStoredPrefixLength);
+            // a key that ends within the prefix does not match it
+            uint32_t available = k.getKeyLen() > level ? std::min(k.getKeyLen() - level, length) : 0;
             Key kt;
-            for (uint32_t i = 0; i < n->getPrefixLength(); ++i) {
-                if (i == maxStoredPrefixLength) {
-                    loadKey(N::getAnyChildTid(n), kt);
-                }
-                uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
-                if (curKey != k[level]) {
-                    nonMatchingKey = curKey;
-                    if (n->getPrefixLength() > maxStoredPrefixLength) {
-                        if (i < maxStoredPrefixLength) {
-                            loadKey(N::getAnyChildTid(n), kt);
-                        }
-                        for (uint32_t j = 0; j < std::min((n->getPrefixLength() - (level - prevLevel) - 1),
-                                                          maxStoredPrefixLength); ++j) {
-                            nonMatchingPrefix[j] = kt[level + j + 1];
-                        }
-                    } else {
-                        for (uint32_t j = 0; j < n->getPrefixLength() - i - 1; ++j) {
-                            nonMatchingPrefix[j] = n->getPrefix()[i + j + 1];
-                        }
+            uint32_t i = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, std::min(stored, available));
+            if (i == stored && length > maxStoredPrefixLength) {
+                loadKey(N::getAnyChildTid(n), kt);
+                i += NodeSearch::mismatch(kt.getData() + level + i, k.getData() + level + i, available - i);
+            }
+            level += i;
+            if (i < length) {
+                nonMatchingKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
+                if (length > maxStoredPrefixLength) {
+                    if (i < maxStoredPrefixLength) {
+                        loadKey(N::getAnyChildTid(n), kt);
+                    }
+                    for (uint32_t j = 0; j < std::min((length - (level - prevLevel) - 1),
+                                                      maxStoredPrefixLength); ++j) {
+                        nonMatchingPrefix[j] = kt[level + j + 1];
+                    }
+                } else {
+                    for (uint32_t j = 0; j < length - i - 1; ++j) {
+                        nonMatchingPrefix[j] = n->getPrefix()[i + j + 1];
                     }
-                    return CheckPrefixPessimisticResult::NoMatch;
                 }
-                ++level;
+                return CheckPrefixPessimisticResult::NoMatch;
             }
         }
         return CheckPrefixPessimisticResult::Match;
@@ -463,12 +535,22 @@ namespace ART_unsynchronized {
     typename Tree::PCCompareResults Tree::checkPrefixCompare(N *n, const Key &k, uint32_t &level,
                                                         LoadKeyFunction loadKey) {
         if (n->hasPrefix()) {
+            uint32_t length = n->getPrefixLength();
+            uint32_t stored = std::min(length, maxStoredPrefixLength);
+            // the prefix bytes behind the end of k are compared with 0
+            uint32_t available = k.getKeyLen() > level ? std::min(k.getKeyLen() - level, length) : 0;
             Key kt;
-            for (uint32_t i = 0; i < n->getPrefixLength(); ++i) {
-                if (i == maxStoredPrefixLength) {
+            uint32_t i = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, std::min(stored, available));
+            if (i == stored && length > maxStoredPrefixLength) {
+                loadKey(N::getAnyChildTid(n), kt);
+                i += NodeSearch::mismatch(kt.getData() + level + i, k.getData() + level + i, available - i);
+            }
+            level += i;
+            for (; i < length; ++i) {
+                if (i == maxStoredPrefixLength && kt.getKeyLen() == 0) {
                     loadKey(N::getAnyChildTid(n), kt);
                 }
-                uint8_t kLevel = (k.getKeyLen() > level) ? k[level] : 0;
+                uint8_t kLevel = i < available ? k[level] : 0;
 
                 uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
                 if (curKey < kLevel) {
@@ -512,44 +594,67 @@ namespace ART_unsynchronized {
     }
 
     double Tree::calculateAverageHeight() const {
-        uint64_t totalDepth = 0;
-        uint64_t leafCount = 0;
-        
-        std::function<void(const N*, uint32_t)> traverse = [&](const N* node, uint32_t depth) {
-            if (N::isLeaf(node)) {
-                totalDepth += depth;
-                leafCount++;
-            } else {
-                std::tuple<uint8_t, N*> children[256];
-                uint32_t childrenCount = 0;
-                N::getChildren(node, 0u, 255u, children, childrenCount);
-                for (uint32_t i = 0; i < childrenCount; ++i) {
-                    traverse(std::get<1>(children[i]), depth + 1);
-                }
-            }
-        };
-        
-        traverse(root, 0);
-        
-        return leafCount > 0 ? static_cast<double>(totalDepth) / leafCount : 0.0;
+        return collectStats().getAverageLeafDepth();
+    }
+
+    TreeStats Tree::collectStats(unsigned threads) const {
+        // an N65536 has up to 65536 children
+        return collectTreeStats<65536>(root, threads, [](const N *node, uint32_t level, TreeStats &stats,
+                                                         std::tuple<uint8_t, N *> children[], uint32_t &childrenCount) {
+            N::getChildren(node, 0u, 255u, children, childrenCount);
+            stats.addNode(static_cast<unsigned>(node->getType()), N::getNodeSize(node), level, childrenCount,
+                          node->getPrefixLength(), maxStoredPrefixLength);
+        });
     }
 
-void Tree::bulkload(const std::vector<std::pair<Key, TID>>& keyTidPairs) {
+// the bytes of the node the bulkload creates for this many children
+static std::size_t bulkloadNodeSize(std::size_t children) {
+    if (children <= 4) {
+        return sizeof(N4);
+    } else if (children <= 16) {
+        return sizeof(N16);
+    } else if (children <= 32) {
+        return sizeof(N32);
+    } else if (children <= 48) {
+        return sizeof(N48);
+    }
+    return sizeof(N256);
+}
+
+void Tree::bulkload(const std::vector<std::pair<Key, TID>>& keyTidPairs, double maxSpanOverhead) {
     if (keyTidPairs.empty()) {
         return;
     }
-    root = bulkloadRecursive(keyTidPairs, 0);
+    N::deleteChildren(root);
+    N::deleteNode(root);
+    root = bulkloadRecursive(keyTidPairs, 0, maxSpanOverhead);
 }
 
-N* Tree::bulkloadRecursive(const std::vector<std::pair<Key, TID>>& pairs, uint32_t depth) {
+N* Tree::bulkloadRecursive(const std::vector<std::pair<Key, TID>>& pairs, uint32_t depth, double maxSpanOverhead) {
     if (pairs.empty()) {
         return nullptr;
     }
 
     // 如果只有一个键值对，直接创建叶子节点
     if (pairs.size() == 1) {
-        return N::setLeaf(pairs[0].second);
+        return N::setLeaf(pairs[0].second, pairs[0].first);
+    }
+#ifdef ART_LEAF_BUCKETS
+    // the root stays an inner node
+    if (depth > 0 && pairs.size() <= maxBucketSize) {
+        std::vector<std::pair<Key, TID>> sorted(pairs);
+        std::sort(sorted.begin(), sorted.end(), [](const std::pair<Key, TID> &a, const std::pair<Key, TID> &b) {
+            return a.first < b.first;
+        });
+        N *leaves[maxBucketSize];
+        Key keys[maxBucketSize];
+        for (std::size_t i = 0; i < sorted.size(); i++) {
+            leaves[i] = N::setLeaf(sorted[i].second, sorted[i].first);
+            keys[i] = sorted[i].first;
+        }
+        return Bucket::build(leaves, keys, static_cast<uint32_t>(sorted.size()), depth);
     }
+#endif
 
     // 1. 按当前字节将键值对分成256个分区
     std::array<std::vector<std::pair<Key, TID>>, 256> partitions;
@@ -568,10 +673,44 @@ N* Tree::bulkloadRecursive(const std::vector<std::pair<Key, TID>>& pairs, uint32
         }
     }
 
+    // the node and the inner nodes below it against one N65536 that consumes both key bytes
+    bool spanFits = maxSpanOverhead > 0;
+    std::size_t twoLevelBytes = bulkloadNodeSize(nonEmptyPartitions);
+    for (const auto& partition : partitions) {
+        std::bitset<256> secondBytes;
+        for (const auto& pair : partition) {
+            spanFits &= pair.first.getKeyLen() >= depth + 2;
+            if (spanFits) {
+                secondBytes.set(pair.first[depth + 1]);
+            }
+        }
+        if (partition.size() > 1) {
+            twoLevelBytes += bulkloadNodeSize(secondBytes.count());
+        }
+    }
+    if (spanFits && sizeof(N65536) <= maxSpanOverhead * twoLevelBytes) {
+        auto span = new N65536(nullptr, 0);
+        for (uint16_t i = 0; i < 256; i++) {
+            std::array<std::vector<std::pair<Key, TID>>, 256> secondPartitions;
+            for (const auto& pair : partitions[i]) {
+                secondPartitions[pair.first[depth + 1]].push_back(pair);
+            }
+            for (uint16_t j = 0; j < 256; j++) {
+                if (!secondPartitions[j].empty()) {
+                    span->insert(static_cast<uint16_t>(i << 8 | j),
+                                 bulkloadRecursive(secondPartitions[j], depth + 2, maxSpanOverhead));
+                }
+            }
+        }
+        return span;
+    }
+
     if (nonEmptyPartitions <= 4) {
         node = new N4(nullptr, 0);
     } else if (nonEmptyPartitions <= 16) {
         node = new N16(nullptr, 0);
+    } else if (nonEmptyPartitions <= 32) {
+        node = new N32(nullptr, 0);
     } else if (nonEmptyPartitions <= 48) {
         node = new N48(nullptr, 0);
     } else {
@@ -584,10 +723,10 @@ N* Tree::bulkloadRecursive(const std::vector<std::pair<Key, TID>>& pairs, uint32
             // 如果分区中只有一个元素且已经到达键的末尾，创建叶子节点
             if (partitions[i].size() == 1 && 
                 depth >= partitions[i][0].first.getKeyLen() - 1) {
-                node->insert(i, N::setLeaf(partitions[i][0].second));
+                node->insert(i, N::setLeaf(partitions[i][0].second, partitions[i][0].first));
             } else {
                 // 否则递归构建子树
-                N* child = bulkloadRecursive(partitions[i], depth + 1);
+                N* child = bulkloadRecursive(partitions[i], depth + 1, maxSpanOverhead);
                 if (child != nullptr) {
                     node->insert(i, child);
                 }
@@ -5,6 +5,7 @@
 #ifndef ARTVERSION1_TREE_H
 #define ARTVERSION1_TREE_H
 #include "N.h"
+#include "../TreeStats.h"
 
 using namespace ART;
 
@@ -20,6 +21,13 @@ namespace ART_unsynchronized {
 
         TID checkKey(const TID tid, const Key &k) const;
 
+        TID lookupBucket(const Bucket *b, const Key &k, uint32_t level, bool optimisticPrefixMatch) const;
+
+        /**
+         * replaces the bucket by its last leaf or a smaller bucket if it gets too empty
+         */
+        void removeFromBucket(Bucket *b, N *parentNode, uint16_t parentKey, const Key &k, uint32_t level, TID tid);
+
         LoadKeyFunction loadKey;
 
         enum class CheckPrefixResult : uint8_t {
@@ -75,11 +83,21 @@ namespace ART_unsynchronized {
         void remove(const Key &k, TID tid);
 
         double calculateAverageHeight() const;
+
+        /**
+         * structural statistics collected by a parallel traversal, the tree must not be modified meanwhile
+         */
+        TreeStats collectStats(unsigned threads = std::thread::hardware_concurrency()) const;
     // public:
         // void bulkLoad(const std::vector<std::pair<Key, TID>>& kvs, N *parent, uint8_t level);
 
-        void bulkload(const std::vector<std::pair<Key, TID>>& keyTidPairs);
-        N* bulkloadRecursive(const std::vector<std::pair<Key, TID>>& keyTidPairs, uint32_t level);
+        /**
+         * builds the tree from keyTidPairs and replaces the root. A node and the inner nodes below it become one
+         * N65536 where it needs at most maxSpanOverhead times their bytes, a lookup then saves a level there. 0
+         * builds one key byte per level.
+         */
+        void bulkload(const std::vector<std::pair<Key, TID>>& keyTidPairs, double maxSpanOverhead = 1.0);
+        N* bulkloadRecursive(const std::vector<std::pair<Key, TID>>& keyTidPairs, uint32_t level, double maxSpanOverhead);
 
         // N* buildSubtree(const std::vector<std::pair<Key, TID>>& keyTidPairs, N* parentNode, uint8_t parentKey, uint32_t level);
 
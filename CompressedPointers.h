@@ -0,0 +1,337 @@
+#ifndef ART_COMPRESSEDPOINTERS_H
+#define ART_COMPRESSEDPOINTERS_H
+
+#include <sys/mman.h>
+#include <stdint.h>
+#include <assert.h>
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ART {
+
+#ifdef ART_COMPRESSED_POINTERS
+
+    template<typename T = void>
+    struct RegionBase {
+        static char *base;
+    };
+
+    template<typename T>
+    char *RegionBase<T>::base = nullptr;
+
+    /**
+     * One address range reserved at startup that all nodes are allocated from, so that a node is identified by
+     * its offset in 8 byte units. Memory is only committed when it is touched. Threads cut small nodes from their
+     * own 64 KB spans and keep freed nodes in per-size pools, larger nodes get spans of their own. The node arenas
+     * take their mappings from the region as well. The region is never unmapped.
+     */
+    class CompressedRegion {
+    public:
+        static constexpr std::size_t unit = 8;
+        // 30 bits of offset
+        static constexpr std::size_t maxSize = unit << 30;
+        static constexpr std::size_t spanSize = 64 * 1024;
+        static constexpr std::size_t hugePageSize = 2 * 1024 * 1024;
+        static constexpr std::size_t pageSize = 4096;
+
+        static std::size_t pageAligned(std::size_t size) {
+            return (size + pageSize - 1) & ~(pageSize - 1);
+        }
+
+    private:
+        struct Pool {
+            std::size_t size = 0;
+            void *head = nullptr;
+        };
+
+        using Pools = std::array<Pool, 16>;
+
+        struct ThreadCache {
+            char *cursor = nullptr;
+            char *end = nullptr;
+            Pools pools;
+
+            ~ThreadCache() {
+                CompressedRegion::get().adoptPools(pools);
+            }
+        };
+
+        std::mutex mutex;
+        char *next;
+        char *end;
+        std::vector<std::pair<char *, std::size_t>> freeSpans;
+        Pools pools;
+
+        static bool push(Pools &pools, void *p, std::size_t size) {
+            for (auto &pool : pools) {
+                if (pool.size == 0) {
+                    pool.size = size;
+                }
+                if (pool.size == size) {
+                    *static_cast<void **>(p) = pool.head;
+                    pool.head = p;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void *pop(Pools &pools, std::size_t size) {
+            for (auto &pool : pools) {
+                if (pool.size == size && pool.head != nullptr) {
+                    void *p = pool.head;
+                    pool.head = *static_cast<void **>(p);
+                    return p;
+                }
+            }
+            return nullptr;
+        }
+
+        static ThreadCache &threadCache() {
+            static thread_local ThreadCache cache;
+            return cache;
+        }
+
+        CompressedRegion() {
+            // smaller reservations if the address space is limited
+            for (std::size_t size = maxSize; size >= 64 * hugePageSize; size /= 2) {
+                void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                               -1, 0);
+                if (p != MAP_FAILED) {
+                    char *base = static_cast<char *>(p);
+                    uintptr_t start = (reinterpret_cast<uintptr_t>(p) + hugePageSize - 1) & ~(hugePageSize - 1);
+                    // offset 0 is the null reference, the first huge page is left out
+                    next = reinterpret_cast<char *>(start) + hugePageSize;
+                    end = base + size;
+#ifdef MADV_HUGEPAGE
+                    madvise(next, end - next, MADV_HUGEPAGE);
+#endif
+                    RegionBase<>::base = base;
+                    return;
+                }
+            }
+            throw std::bad_alloc();
+        }
+
+        void adoptPools(Pools &threadPools) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &pool : threadPools) {
+                while (pool.head != nullptr) {
+                    void *p = pool.head;
+                    pool.head = *static_cast<void **>(p);
+                    push(pools, p, pool.size);
+                }
+            }
+        }
+
+        void *refill(ThreadCache &cache, std::size_t size) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (void *p = pop(pools, size)) {
+                    return p;
+                }
+            }
+            cache.cursor = allocateSpan(spanSize, unit);
+            cache.end = cache.cursor + spanSize;
+            void *p = cache.cursor;
+            cache.cursor += size;
+            return p;
+        }
+
+    public:
+        CompressedRegion(const CompressedRegion &) = delete;
+
+        static CompressedRegion &get() {
+            // never destroyed, threads may still return their caches at exit
+            static CompressedRegion *region = new CompressedRegion();
+            return *region;
+        }
+
+        static char *getBase() {
+            return RegionBase<>::base;
+        }
+
+        /**
+         * bytes from the region aligned to align, a power of two
+         */
+        char *allocateSpan(std::size_t bytes, std::size_t align) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = freeSpans.begin(); it != freeSpans.end(); ++it) {
+                if (it->second == bytes && (reinterpret_cast<uintptr_t>(it->first) & (align - 1)) == 0) {
+                    char *span = it->first;
+                    freeSpans.erase(it);
+                    return span;
+                }
+            }
+            char *span = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(next) + align - 1) & ~(align - 1));
+            if (span > end || static_cast<std::size_t>(end - span) < bytes) {
+                throw std::bad_alloc();
+            }
+            next = span + bytes;
+            return span;
+        }
+
+        /**
+         * gives the memory of a span back to the system, its addresses are handed out again
+         */
+        void releaseSpan(char *span, std::size_t bytes) {
+            madvise(span, bytes, MADV_DONTNEED);
+            std::lock_guard<std::mutex> lock(mutex);
+            freeSpans.emplace_back(span, bytes);
+        }
+
+        void *allocate(std::size_t size) {
+            if (size > spanSize) {
+                // nodes larger than a span, the N65536 of the unsynchronized tree, get one of their own
+                return allocateSpan(pageAligned(size), pageSize);
+            }
+            size = (size + unit - 1) & ~(unit - 1);
+            ThreadCache &cache = threadCache();
+            if (void *p = pop(cache.pools, size)) {
+                return p;
+            }
+            if (static_cast<std::size_t>(cache.end - cache.cursor) < size) {
+                return refill(cache, size);
+            }
+            void *p = cache.cursor;
+            cache.cursor += size;
+            return p;
+        }
+
+        void free(void *p, std::size_t size) {
+            if (size > spanSize) {
+                releaseSpan(static_cast<char *>(p), pageAligned(size));
+                return;
+            }
+            size = (size + unit - 1) & ~(unit - 1);
+            if (!push(threadCache().pools, p, size)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                push(pools, p, size);
+            }
+        }
+    };
+
+    /**
+     * A child slot of 4 bytes instead of a pointer. The references of inner nodes and leaves are converted from
+     * and to the N * the trees work with:
+     *   0                      nullptr
+     *   1 << 31 | tid          a leaf with a TID below 2^31
+     *   1 << 30 | offset       a leaf whose TID is stored in an 8 byte cell at offset
+     *   offset                 an inner node
+     * Offsets are in units of CompressedRegion::unit from the start of the region. Leaves with a cell are
+     * N * with the two top bits set, N::getLeaf reads the TID from the cell.
+     */
+    template<typename N>
+    class ChildRef {
+        static constexpr uint64_t leafBit = static_cast<uint64_t>(1) << 63;
+        static constexpr uint64_t cellBit = static_cast<uint64_t>(1) << 62;
+        static constexpr uint32_t inlineRef = static_cast<uint32_t>(1) << 31;
+        static constexpr uint32_t cellRef = static_cast<uint32_t>(1) << 30;
+
+        uint32_t ref;
+
+        static uint32_t offsetOf(uint64_t p) {
+            uint64_t offset = (p - reinterpret_cast<uint64_t>(RegionBase<>::base)) / CompressedRegion::unit;
+            assert(offset < cellRef);
+            return static_cast<uint32_t>(offset);
+        }
+
+        static uint32_t encode(N *n) {
+            uint64_t p = reinterpret_cast<uint64_t>(n);
+            if (p == 0) {
+                return 0;
+            }
+            if ((p & leafBit) == 0) {
+                return offsetOf(p);
+            }
+            if ((p & cellBit) != 0) {
+                return cellRef | offsetOf(p & ~(leafBit | cellBit));
+            }
+            assert((p & ~leafBit) < inlineRef);
+            return inlineRef | static_cast<uint32_t>(p);
+        }
+
+        static N *decode(uint32_t ref) {
+            if (ref == 0) {
+                return nullptr;
+            }
+            if ((ref & inlineRef) != 0) {
+                return reinterpret_cast<N *>(leafBit | (ref & ~inlineRef));
+            }
+            uint64_t p = reinterpret_cast<uint64_t>(RegionBase<>::base) +
+                         static_cast<uint64_t>(ref & ~cellRef) * CompressedRegion::unit;
+            return reinterpret_cast<N *>((ref & cellRef) != 0 ? p | leafBit | cellBit : p);
+        }
+
+    public:
+        ChildRef() = default;
+
+        ChildRef(std::nullptr_t) : ref(0) { }
+
+        ChildRef(N *n) : ref(encode(n)) { }
+
+        operator N *() const {
+            return decode(ref);
+        }
+
+        N *operator->() const {
+            return decode(ref);
+        }
+
+        bool operator==(std::nullptr_t) const {
+            return ref == 0;
+        }
+
+        bool operator!=(std::nullptr_t) const {
+            return ref != 0;
+        }
+
+        /**
+         * whether a TID fits into a reference without a cell
+         */
+        static bool isInline(uint64_t tid) {
+            return tid < inlineRef;
+        }
+
+        static bool isCell(const N *n) {
+            return (reinterpret_cast<uint64_t>(n) & cellBit) != 0;
+        }
+
+        static uint64_t *getCell(const N *n) {
+            return reinterpret_cast<uint64_t *>(reinterpret_cast<uint64_t>(n) & ~(leafBit | cellBit));
+        }
+
+        static N *setCell(uint64_t *cell) {
+            return reinterpret_cast<N *>(reinterpret_cast<uint64_t>(cell) | leafBit | cellBit);
+        }
+    };
+
+    inline void *allocateNodeMemory(std::size_t size) {
+        return CompressedRegion::get().allocate(size);
+    }
+
+    inline void freeNodeMemory(void *n, std::size_t size) {
+        CompressedRegion::get().free(n, size);
+    }
+
+#else
+
+    template<typename N>
+    using ChildRef = N *;
+
+    inline void *allocateNodeMemory(std::size_t size) {
+        return operator new(size);
+    }
+
+    inline void freeNodeMemory(void *n, std::size_t) {
+        operator delete(n);
+    }
+
+#endif
+}
+
+#endif //ART_COMPRESSEDPOINTERS_H
@@ -5,7 +5,12 @@
 #define EPOCHE_CPP
 
 #include <assert.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <new>
+#include <stdexcept>
 #include "Epoche.h"
 using namespace ART;
 
@@ -19,6 +24,14 @@ inline DeletionList::~DeletionList() {
         delete cur;
     }
     freeLabelDeletes = nullptr;
+    // arena memory goes away with the arena
+    for (auto &c : nodeClasses) {
+        while (arena == nullptr && c.freeHead != nullptr) {
+            void *n = c.freeHead;
+            c.freeHead = *static_cast<void **>(n);
+            freeNodeMemory(n, c.size.load(std::memory_order_relaxed));
+        }
+    }
 }
 
 inline std::size_t DeletionList::size() {
@@ -32,13 +45,14 @@ inline void DeletionList::remove(LabelDelete *label, LabelDelete *prev) {
         prev->next = label->next;
     }
     deletitionListCount -= label->nodesCount;
+    pendingBytes.store(pendingBytes.load(std::memory_order_relaxed) - label->bytes, std::memory_order_relaxed);
 
     label->next = freeLabelDeletes;
     freeLabelDeletes = label;
     deleted += label->nodesCount;
 }
 
-inline void DeletionList::add(void *n, uint64_t globalEpoch) {
+inline void DeletionList::add(void *n, std::size_t size, uint64_t globalEpoch) {
     deletitionListCount++;
     LabelDelete *label;
     if (headDeletionList != nullptr && headDeletionList->nodesCount < headDeletionList->nodes.size()) {
@@ -51,99 +65,628 @@ inline void DeletionList::add(void *n, uint64_t globalEpoch) {
             label = new LabelDelete();
         }
         label->nodesCount = 0;
+        label->bytes = 0;
         label->next = headDeletionList;
         headDeletionList = label;
     }
     label->nodes[label->nodesCount] = n;
+    label->sizes[label->nodesCount] = size;
     label->nodesCount++;
+    label->bytes += size;
     label->epoche = globalEpoch;
+    pendingBytes.store(pendingBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    if (NodeClass *c = getNodeClass(size)) {
+        c->retiredBytes.store(c->retiredBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    }
 
     added++;
 }
 
+inline LabelDelete *DeletionList::takeAll() {
+    LabelDelete *labels = headDeletionList;
+    headDeletionList = nullptr;
+    deletitionListCount = 0;
+    pendingBytes.store(0, std::memory_order_relaxed);
+    return labels;
+}
+
+inline void DeletionList::adopt(LabelDelete *labels) {
+    std::size_t bytes = 0;
+    while (labels != nullptr) {
+        LabelDelete *next = labels->next;
+        labels->next = headDeletionList;
+        headDeletionList = labels;
+        deletitionListCount += labels->nodesCount;
+        bytes += labels->bytes;
+        labels = next;
+    }
+    pendingBytes.store(pendingBytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+}
+
+inline DeletionList::NodeClass *DeletionList::getNodeClass(std::size_t size) {
+    for (auto &c : nodeClasses) {
+        std::size_t classSize = c.size.load(std::memory_order_relaxed);
+        if (classSize == 0) {
+            c.size.store(size, std::memory_order_relaxed);
+            return &c;
+        }
+        if (classSize == size) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+inline void *DeletionList::allocateNode(std::size_t size, bool interleaved) {
+    NodeClass *c = getNodeClass(size);
+    if (c != nullptr) {
+        c->allocatedBytes.store(c->allocatedBytes.load(std::memory_order_relaxed) + size,
+                                std::memory_order_relaxed);
+    }
+    if (interleaved && interleavedArena != nullptr) {
+        return interleavedArena->allocate(size);
+    }
+    if (c != nullptr) {
+        if (void *n = c->freeHead) {
+            c->freeHead = *static_cast<void **>(n);
+            c->freeCount.store(c->freeCount.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            return n;
+        }
+    }
+    if (arena == nullptr) {
+        return allocateNodeMemory(size);
+    }
+    return allocateFromArena(size);
+}
+
+inline void *DeletionList::allocateFromArena(std::size_t size) {
+    // nodes stay aligned like memory from operator new
+    std::size_t alignedSize = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    if (static_cast<std::size_t>(chunkEnd - chunkCursor) < alignedSize) {
+        if (void *n = arena->takeReleased(size)) {
+            return n;
+        }
+        chunkCursor = arena->allocateChunk();
+        chunkEnd = chunkCursor + NodeArena::chunkSize;
+    }
+    void *n = chunkCursor;
+    chunkCursor += alignedSize;
+    return n;
+}
+
+inline void DeletionList::reclaimNode(void *n, std::size_t size) {
+    NodeClass *c = getNodeClass(size);
+    if (c == nullptr) {
+        if (arena == nullptr) {
+            freeNodeMemory(n, size);
+        } else {
+            // stays mapped until the arena goes away if there is no pool left for its size
+            arena->release(n, size);
+        }
+        return;
+    }
+    c->reclaimedBytes.store(c->reclaimedBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    uint32_t freeCount = c->freeCount.load(std::memory_order_relaxed);
+    if (freeCount >= maxFreeNodes) {
+        if (arena == nullptr) {
+            freeNodeMemory(n, size);
+            return;
+        }
+        if (arena->release(n, size)) {
+            return;
+        }
+    }
+    *static_cast<void **>(n) = c->freeHead;
+    c->freeHead = n;
+    c->freeCount.store(freeCount + 1, std::memory_order_relaxed);
+}
+
+inline void DeletionList::discardNode(void *n, std::size_t size) {
+    if (NodeClass *c = getNodeClass(size)) {
+        c->retiredBytes.store(c->retiredBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    }
+    reclaimNode(n, size);
+}
+
+inline void DeletionList::addMemoryUsage(MemoryUsage &usage) const {
+    for (auto &c : nodeClasses) {
+        std::size_t size = c.size.load(std::memory_order_relaxed);
+        if (size == 0) {
+            break;
+        }
+        uint64_t allocated = c.allocatedBytes.load(std::memory_order_relaxed);
+        uint64_t retired = c.retiredBytes.load(std::memory_order_relaxed);
+        uint64_t reclaimed = c.reclaimedBytes.load(std::memory_order_relaxed);
+        // counted per thread, a node can be allocated, retired and reclaimed by different threads. The sums
+        // over all threads are the differences of the totals.
+        NodeMemory &m = usage.get(size);
+        m.liveBytes += allocated - retired;
+        m.pendingBytes += retired - reclaimed;
+        m.cachedBytes += c.freeCount.load(std::memory_order_relaxed) * size;
+    }
+}
+
 inline LabelDelete *DeletionList::head() {
     return headDeletionList;
 }
 
+inline EpocheRegistry &EpocheRegistry::get() {
+    static EpocheRegistry registry;
+    return registry;
+}
+
+inline ThreadSlots &ThreadSlots::local() {
+    static thread_local ThreadSlots slots;
+    return slots;
+}
+
+inline DeletionList &ThreadSlots::get(Epoche &epoche) {
+    for (auto &e : entries) {
+        if (e.epoche == &epoche && e.epocheId == epoche.id) {
+            return *e.deletionList;
+        }
+    }
+    EpocheRegistry &registry = EpocheRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    // forget the slots of Epoches that have been destroyed since
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&registry](const Entry &e) {
+        return registry.alive.count(e.epocheId) == 0;
+    }), entries.end());
+    DeletionList *deletionList = epoche.acquireSlot();
+    entries.push_back({epoche.id, &epoche, deletionList});
+    return *deletionList;
+}
+
+inline ThreadSlots::~ThreadSlots() {
+    EpocheRegistry &registry = EpocheRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &e : entries) {
+        if (registry.alive.count(e.epocheId) != 0) {
+            e.epoche->releaseSlot(e.deletionList);
+        }
+    }
+}
+
+inline Epoche::Epoche(size_t startGCThreshhold, ReclamationMode reclamationMode, NodeAllocator nodeAllocator,
+                      size_t maxThreads)
+        : topology(NumaTopology::get()), maxThreads(maxThreads), startGCThreshhold(startGCThreshhold),
+          reclamationMode(reclamationMode), nodeAllocator(nodeAllocator) {
+    if (nodeAllocator == NodeAllocator::HugePageArena) {
+        arenas.emplace_back(new NodeArena());
+    } else if (nodeAllocator == NodeAllocator::NumaArena) {
+        for (unsigned n = 0; n < topology.getNodeCount(); ++n) {
+            arenas.emplace_back(new NodeArena(&topology, n));
+        }
+        interleavedArena.reset(new NodeArena(&topology));
+    }
+    socketEpoches = static_cast<SocketEpoche *>(aligned_alloc(alignof(SocketEpoche),
+                                                              sizeof(SocketEpoche) * topology.getNodeCount()));
+    // slots are constructed when they are handed out for the first time
+    deletionLists = static_cast<DeletionList *>(aligned_alloc(alignof(DeletionList),
+                                                              sizeof(DeletionList) * (maxThreads + 1)));
+    if (socketEpoches == nullptr || deletionLists == nullptr) {
+        free(socketEpoches);
+        free(deletionLists);
+        throw std::bad_alloc();
+    }
+    for (unsigned n = 0; n < topology.getNodeCount(); ++n) {
+        new(&socketEpoches[n]) SocketEpoche();
+    }
+    new(&deletionLists[maxThreads]) DeletionList(0, getArena(0), nullptr, 0);
+    EpocheRegistry &registry = EpocheRegistry::get();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    id = registry.nextId++;
+    registry.alive.insert(id);
+    if (reclamationMode == ReclamationMode::Background) {
+        reclaimer = std::thread([this]() { reclaim(); });
+    }
+}
+
+inline NodeArena *Epoche::getArena(unsigned numaNode) const {
+    if (arenas.empty()) {
+        return nullptr;
+    }
+    return arenas[numaNode < arenas.size() ? numaNode : 0].get();
+}
+
+inline DeletionList *Epoche::acquireSlot() {
+    unsigned numaNode = topology.getCurrentNode();
+    for (auto it = freeSlots.rbegin(); it != freeSlots.rend(); ++it) {
+        if (deletionLists[*it].numaNode == numaNode) {
+            std::size_t slot = *it;
+            freeSlots.erase(std::next(it).base());
+            return &deletionLists[slot];
+        }
+    }
+    std::size_t slot = usedSlots.load(std::memory_order_relaxed);
+    if (slot == maxThreads) {
+        if (freeSlots.empty()) {
+            throw std::runtime_error("Epoche: more threads registered than maxThreads");
+        }
+        // a slot of another node, its arena and epoche copy are remote
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        return &deletionLists[slot];
+    }
+    new(&deletionLists[slot]) DeletionList(numaNode, getArena(numaNode), interleavedArena.get());
+    usedSlots.store(slot + 1, std::memory_order_release);
+    return &deletionLists[slot];
+}
+
+inline void Epoche::releaseSlot(DeletionList *deletionList) {
+    deletionList->localEpoche.store(std::numeric_limits<uint64_t>::max());
+    retire(deletionList->takeAll());
+    deletionList->thresholdCounter = 0;
+    freeSlots.push_back(deletionList - deletionLists);
+}
+
+inline void Epoche::retire(LabelDelete *labels) {
+    if (labels == nullptr) {
+        return;
+    }
+    std::size_t bytes = labels->bytes;
+    LabelDelete *last = labels;
+    while (last->next != nullptr) {
+        last = last->next;
+        bytes += last->bytes;
+    }
+    retiredBytes += bytes;
+    last->next = retiredLabels.load();
+    while (!retiredLabels.compare_exchange_weak(last->next, labels)) { }
+}
+
+inline LabelDelete *Epoche::takeRetired() {
+    if (retiredLabels.load(std::memory_order_relaxed) == nullptr) {
+        return nullptr;
+    }
+    return retiredLabels.exchange(nullptr);
+}
+
 inline void Epoche::enterEpoche(ThreadInfo &epocheInfo) {
-    unsigned long curEpoche = currentEpoche.load(std::memory_order_relaxed);
-    epocheInfo.getDeletionList().localEpoche.store(curEpoche, std::memory_order_release);
+    if (reclamationMode == ReclamationMode::Quiescent) {
+        // only a thread that is offline has to announce itself again
+        DeletionList &deletionList = epocheInfo.getDeletionList();
+        if (deletionList.localEpoche.load(std::memory_order_relaxed) == std::numeric_limits<uint64_t>::max()) {
+            deletionList.localEpoche.store(socketEpoches[deletionList.numaNode].epoche.load());
+        }
+        return;
+    }
+    DeletionList &deletionList = epocheInfo.getDeletionList();
+    unsigned long curEpoche = socketEpoches[deletionList.numaNode].epoche.load(std::memory_order_relaxed);
+    deletionList.localEpoche.store(curEpoche, std::memory_order_release);
+}
+
+inline void Epoche::markNodeForDeletion(void *n, std::size_t size, ThreadInfo &epocheInfo) {
+    DeletionList &deletionList = epocheInfo.getDeletionList();
+    deletionList.add(n, size, currentEpoche.load());
+    deletionList.thresholdCounter++;
+    // advanced here and not on exit, a session can mark many nodes before it leaves the epoche
+    if (reclamationMode != ReclamationMode::Background && (deletionList.thresholdCounter & (64 - 1)) == 1) {
+        advanceEpoche(deletionList);
+    }
+}
+
+inline void Epoche::advanceEpoche(DeletionList &deletionList) {
+    SocketEpoche &socket = socketEpoches[deletionList.numaNode];
+    uint64_t global = currentEpoche.load();
+    if (socket.epoche.load(std::memory_order_relaxed) == global) {
+        global = ++currentEpoche;
+    }
+    socket.epoche.store(global);
+}
+
+inline void Epoche::publishEpoche() {
+    uint64_t global = currentEpoche.load();
+    for (unsigned n = 0; n < topology.getNodeCount(); ++n) {
+        if (socketEpoches[n].epoche.load(std::memory_order_relaxed) < global) {
+            socketEpoches[n].epoche.store(global);
+        }
+    }
 }
 
-inline void Epoche::markNodeForDeletion(void *n, ThreadInfo &epocheInfo) {
-    epocheInfo.getDeletionList().add(n, currentEpoche.load());
-    epocheInfo.getDeletionList().thresholdCounter++;
+inline void *Epoche::allocateNode(std::size_t size, uint32_t depth, ThreadInfo &epocheInfo) {
+    return epocheInfo.getDeletionList().allocateNode(size, depth < interleavedDepth);
+}
+
+inline void Epoche::freeNode(void *n, std::size_t size, ThreadInfo &epocheInfo) {
+    epocheInfo.getDeletionList().discardNode(n, size);
+}
+
+inline MemoryUsage Epoche::getMemoryUsage() const {
+    MemoryUsage usage;
+    std::size_t slots = usedSlots.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < slots; ++i) {
+        deletionLists[i].addMemoryUsage(usage);
+    }
+    deletionLists[maxThreads].addMemoryUsage(usage);
+    // wrapped around if a counter was read before the ones of another thread that it depends on
+    for (auto &n : usage.nodes) {
+        for (uint64_t *bytes : {&n.liveBytes, &n.pendingBytes}) {
+            if (*bytes > std::numeric_limits<uint64_t>::max() / 2) {
+                *bytes = 0;
+            }
+        }
+    }
+    return usage;
+}
+
+inline uint64_t Epoche::getOldestEpoche() const {
+    uint64_t oldestEpoche = std::numeric_limits<uint64_t>::max();
+    std::size_t slots = usedSlots.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < slots; ++i) {
+        auto e = deletionLists[i].localEpoche.load();
+        if (e < oldestEpoche) {
+            oldestEpoche = e;
+        }
+    }
+    return oldestEpoche;
 }
 
 inline void Epoche::exitEpocheAndCleanup(ThreadInfo &epocheInfo) {
     DeletionList &deletionList = epocheInfo.getDeletionList();
-    if ((deletionList.thresholdCounter & (64 - 1)) == 1) {
-        currentEpoche++;
+    if (reclamationMode == ReclamationMode::Quiescent) {
+        // collected at the next quiescent state
+        return;
     }
     if (deletionList.thresholdCounter > startGCThreshhold) {
         if (deletionList.size() == 0) {
             deletionList.thresholdCounter = 0;
             return;
         }
-        deletionList.localEpoche.store(std::numeric_limits<uint64_t>::max());
+        if (reclamationMode == ReclamationMode::Background) {
+            retire(deletionList.takeAll());
+            deletionList.thresholdCounter = 0;
+        } else {
+            deletionList.localEpoche.store(std::numeric_limits<uint64_t>::max());
+            cleanup(deletionList);
+        }
+        if (isBounded()) {
+            applyBackpressure(deletionList);
+        }
+    }
+}
+
+inline void Epoche::exitEpocheReadonly(ThreadInfo &epocheInfo) {
+    if (reclamationMode != ReclamationMode::Quiescent && isBounded()) {
+        epocheInfo.getDeletionList().localEpoche.store(std::numeric_limits<uint64_t>::max(),
+                                                       std::memory_order_release);
+    }
+}
+
+inline void Epoche::quiescentState(ThreadInfo &epocheInfo) {
+    assert(reclamationMode == ReclamationMode::Quiescent);
+    DeletionList &deletionList = epocheInfo.getDeletionList();
+    deletionList.localEpoche.store(socketEpoches[deletionList.numaNode].epoche.load());
+    if (deletionList.thresholdCounter > startGCThreshhold) {
+        // the nodes retired in the current epoche become free once the others have passed the next one
+        advanceEpoche(deletionList);
+        cleanup(deletionList);
+        if (isBounded()) {
+            // takes the thread offline while it waits, the caller goes on reading nodes afterwards, e.g. in a
+            // refreshed session, and it has to be announced again
+            applyBackpressure(deletionList);
+            deletionList.localEpoche.store(socketEpoches[deletionList.numaNode].epoche.load());
+        }
+    }
+}
+
+inline void Epoche::goOffline(ThreadInfo &epocheInfo) {
+    assert(reclamationMode == ReclamationMode::Quiescent);
+    epocheInfo.getDeletionList().localEpoche.store(std::numeric_limits<uint64_t>::max());
+}
+
+inline ReclamationMode Epoche::getReclamationMode() const {
+    return reclamationMode;
+}
+
+inline NodeAllocator Epoche::getNodeAllocator() const {
+    return nodeAllocator;
+}
+
+inline const NodeArena *Epoche::getNodeArena(unsigned numaNode) const {
+    return getArena(numaNode);
+}
+
+inline const NodeArena *Epoche::getInterleavedArena() const {
+    return interleavedArena.get();
+}
+
+inline const NumaTopology &Epoche::getTopology() const {
+    return topology;
+}
+
+inline void Epoche::applyBackpressure(DeletionList &deletionList) {
+    // limited number of rounds, a reader that never leaves its epoche must not stop writers forever
+    deletionList.localEpoche.store(std::numeric_limits<uint64_t>::max());
+    for (uint32_t round = 0; round < 64 && isOverBudget(); ++round) {
+        std::this_thread::yield();
+        if (reclamationMode != ReclamationMode::Background) {
+            advanceEpoche(deletionList);
+            cleanup(deletionList);
+        }
+    }
+}
+
+inline void Epoche::cleanup(DeletionList &deletionList) {
+    // take over the nodes of threads that left
+    if (LabelDelete *orphans = takeRetired()) {
+        std::size_t bytes = 0;
+        for (LabelDelete *label = orphans; label != nullptr; label = label->next) {
+            bytes += label->bytes;
+        }
+        retiredBytes -= bytes;
+        deletionList.adopt(orphans);
+    }
+
+    // nodes that have not advanced themselves would otherwise announce their old copy for ever
+    publishEpoche();
+    uint64_t oldestEpoche = getOldestEpoche();
+
+    LabelDelete *cur = deletionList.head(), *next, *prev = nullptr;
+    while (cur != nullptr) {
+        next = cur->next;
 
-        uint64_t oldestEpoche = std::numeric_limits<uint64_t>::max();
-        for (auto &epoche : deletionLists) {
-            auto e = epoche.localEpoche.load();
-            if (e < oldestEpoche) {
-                oldestEpoche = e;
+        if (cur->epoche < oldestEpoche) {
+            for (std::size_t i = 0; i < cur->nodesCount; ++i) {
+                deletionList.reclaimNode(cur->nodes[i], cur->sizes[i]);
             }
+            deletionList.remove(cur, prev);
+        } else {
+            prev = cur;
         }
+        cur = next;
+    }
+    deletionList.thresholdCounter = 0;
+}
 
-        LabelDelete *cur = deletionList.head(), *next, *prev = nullptr;
-        while (cur != nullptr) {
-            next = cur->next;
+inline void Epoche::reclaim() {
+    const auto interval = std::chrono::microseconds(200);
+    LabelDelete *pending = nullptr;
+    while (!stopReclaimer.load()) {
+        std::this_thread::sleep_for(interval);
+        currentEpoche++;
+        publishEpoche();
 
-            if (cur->epoche < oldestEpoche) {
-                for (std::size_t i = 0; i < cur->nodesCount; ++i) {
-                    operator delete(cur->nodes[i]);
+        LabelDelete *labels = takeRetired();
+        while (labels != nullptr) {
+            LabelDelete *next = labels->next;
+            labels->next = pending;
+            pending = labels;
+            labels = next;
+        }
+
+        uint64_t oldestEpoche = getOldestEpoche();
+        LabelDelete **cur = &pending;
+        while (*cur != nullptr) {
+            LabelDelete *label = *cur;
+            if (label->epoche < oldestEpoche) {
+                for (std::size_t i = 0; i < label->nodesCount; ++i) {
+                    deletionLists[maxThreads].reclaimNode(label->nodes[i], label->sizes[i]);
                 }
-                deletionList.remove(cur, prev);
+                retiredBytes -= label->bytes;
+                *cur = label->next;
+                delete label;
             } else {
-                prev = cur;
+                cur = &label->next;
             }
-            cur = next;
         }
-        deletionList.thresholdCounter = 0;
+    }
+    // the destructor frees whatever is left
+    while (pending != nullptr) {
+        LabelDelete *next = pending->next;
+        pending->next = retiredLabels.load();
+        retiredLabels.store(pending);
+        pending = next;
     }
 }
 
 inline Epoche::~Epoche() {
-    uint64_t oldestEpoche = std::numeric_limits<uint64_t>::max();
-    for (auto &epoche : deletionLists) {
-        auto e = epoche.localEpoche.load();
-        if (e < oldestEpoche) {
-            oldestEpoche = e;
+    {
+        EpocheRegistry &registry = EpocheRegistry::get();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.alive.erase(id);
+    }
+    if (reclaimer.joinable()) {
+        stopReclaimer.store(true);
+        reclaimer.join();
+    }
+    std::size_t slots = usedSlots.load();
+#ifndef NDEBUG
+    uint64_t oldestEpoche = getOldestEpoche();
+#endif
+    LabelDelete *retired = retiredLabels.exchange(nullptr);
+    while (retired != nullptr) {
+        LabelDelete *next = retired->next;
+        assert(retired->epoche < oldestEpoche);
+        for (std::size_t i = 0; i < retired->nodesCount; ++i) {
+            if (arenas.empty()) {
+                freeNodeMemory(retired->nodes[i], retired->sizes[i]);
+            }
         }
+        delete retired;
+        retired = next;
     }
-    for (auto &d : deletionLists) {
+    for (std::size_t i = 0; i < slots; ++i) {
+        DeletionList &d = deletionLists[i];
         LabelDelete *cur = d.head(), *next, *prev = nullptr;
         while (cur != nullptr) {
             next = cur->next;
 
             assert(cur->epoche < oldestEpoche);
-            for (std::size_t i = 0; i < cur->nodesCount; ++i) {
-                operator delete(cur->nodes[i]);
+            for (std::size_t j = 0; j < cur->nodesCount; ++j) {
+                if (arenas.empty()) {
+                    freeNodeMemory(cur->nodes[j], cur->sizes[j]);
+                }
             }
             d.remove(cur, prev);
             cur = next;
         }
+        d.~DeletionList();
     }
+    deletionLists[maxThreads].~DeletionList();
+    free(deletionLists);
+    free(socketEpoches);
 }
 
 inline void Epoche::showDeleteRatio() {
-    for (auto &d : deletionLists) {
+    std::size_t slots = usedSlots.load();
+    for (std::size_t i = 0; i < slots; ++i) {
+        DeletionList &d = deletionLists[i];
         std::cout << "deleted " << d.deleted << " of " << d.added << std::endl;
     }
 }
 
 inline ThreadInfo::ThreadInfo(Epoche &epoche)
-        : epoche(epoche), deletionList(epoche.deletionLists.local()) { }
+        : epoche(epoche), deletionList(ThreadSlots::local().get(epoche)) { }
+
+inline ThreadInfo::~ThreadInfo() {
+    deletionList.localEpoche.store(std::numeric_limits<uint64_t>::max());
+    // free what is already safe, including what earlier threads left behind, and hand over the rest
+    if (epoche.reclamationMode != ReclamationMode::Background) {
+        epoche.cleanup(deletionList);
+    }
+    epoche.retire(deletionList.takeAll());
+    deletionList.thresholdCounter = 0;
+}
+
+inline std::size_t ThreadInfo::getPendingBytes() const {
+    return deletionList.pendingBytes.load(std::memory_order_relaxed);
+}
+
+inline std::vector<std::size_t> Epoche::getPendingBytesPerThread() const {
+    std::size_t slots = usedSlots.load(std::memory_order_acquire);
+    std::vector<std::size_t> pendingBytes(slots);
+    for (std::size_t i = 0; i < slots; ++i) {
+        pendingBytes[i] = deletionLists[i].pendingBytes.load(std::memory_order_relaxed);
+    }
+    return pendingBytes;
+}
+
+inline std::size_t Epoche::getRetiredBytes() const {
+    return retiredBytes.load(std::memory_order_relaxed);
+}
+
+inline std::size_t Epoche::getPendingBytes() const {
+    std::size_t pendingBytes = retiredBytes.load(std::memory_order_relaxed);
+    std::size_t slots = usedSlots.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < slots; ++i) {
+        pendingBytes += deletionLists[i].pendingBytes.load(std::memory_order_relaxed);
+    }
+    return pendingBytes;
+}
+
+inline void Epoche::setPendingBudget(std::size_t bytes) {
+    pendingBudget.store(bytes);
+}
+
+inline bool Epoche::isBounded() const {
+    return pendingBudget.load(std::memory_order_relaxed) != 0;
+}
+
+inline bool Epoche::isOverBudget() const {
+    std::size_t budget = pendingBudget.load(std::memory_order_relaxed);
+    return budget != 0 && getPendingBytes() > budget;
+}
 
 inline DeletionList &ThreadInfo::getDeletionList() const {
     return deletionList;
@@ -2,37 +2,187 @@
 #define ART_EPOCHE_H
 
 #include <atomic>
+#include <chrono>
 #include <array>
-#include "tbb/enumerable_thread_specific.h"
-#include "tbb/combinable.h"
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+#include "NodeArena.h"
 
 namespace ART {
 
     struct LabelDelete {
         std::array<void*, 32> nodes;
+        std::array<uint32_t, 32> sizes;
         uint64_t epoche;
         std::size_t nodesCount;
+        std::size_t bytes;
         LabelDelete *next;
     };
 
-    class DeletionList {
-        LabelDelete *headDeletionList = nullptr;
+    /**
+     * bytes of the nodes of one size: in the tree, retired and waiting for reclamation, and reclaimed but kept
+     * for reuse
+     */
+    struct NodeMemory {
+        std::size_t nodeSize;
+        uint64_t liveBytes;
+        uint64_t pendingBytes;
+        uint64_t cachedBytes;
+    };
+
+    struct MemoryUsage {
+        /**
+         * one entry per node size, every node type of a tree has its own size
+         */
+        std::vector<NodeMemory> nodes;
+
+        NodeMemory &get(std::size_t nodeSize) {
+            for (auto &n : nodes) {
+                if (n.nodeSize == nodeSize) {
+                    return n;
+                }
+            }
+            nodes.push_back({nodeSize, 0, 0, 0});
+            return nodes.back();
+        }
+
+        uint64_t getLiveBytes() const {
+            uint64_t bytes = 0;
+            for (auto &n : nodes) {
+                bytes += n.liveBytes;
+            }
+            return bytes;
+        }
+
+        uint64_t getPendingBytes() const {
+            uint64_t bytes = 0;
+            for (auto &n : nodes) {
+                bytes += n.pendingBytes;
+            }
+            return bytes;
+        }
+
+        uint64_t getCachedBytes() const {
+            uint64_t bytes = 0;
+            for (auto &n : nodes) {
+                bytes += n.cachedBytes;
+            }
+            return bytes;
+        }
+
+        uint64_t getTotalBytes() const {
+            return getLiveBytes() + getPendingBytes() + getCachedBytes();
+        }
+    };
+
+    /**
+     * the slot of one thread, localEpoche is read by every thread that collects garbage and therefore
+     * lives on its own cache line, apart from the bookkeeping that only the owner touches
+     */
+    class alignas(64) DeletionList {
+    public:
+        std::atomic<uint64_t> localEpoche{std::numeric_limits<uint64_t>::max()};
+
+    private:
+        alignas(64) LabelDelete *headDeletionList = nullptr;
         LabelDelete *freeLabelDeletes = nullptr;
         std::size_t deletitionListCount = 0;
 
+        /**
+         * the bytes of the nodes of one size this thread has allocated, retired and reclaimed, only written by
+         * the owner. Reclaimed nodes are kept for reuse, linked through their first word.
+         */
+        struct NodeClass {
+            std::atomic<std::size_t> size{0};
+            std::atomic<uint64_t> allocatedBytes{0};
+            std::atomic<uint64_t> retiredBytes{0};
+            std::atomic<uint64_t> reclaimedBytes{0};
+            std::atomic<uint32_t> freeCount{0};
+            void *freeHead = nullptr;
+        };
+        const uint32_t maxFreeNodes;
+        // the node types, leaf cells and the four bucket capacities
+        std::array<NodeClass, 12> nodeClasses;
+
+        /**
+         * the chunk new nodes are cut from if nodes are allocated from an arena, the top levels of the tree
+         * come from the interleaved arena if there is one
+         */
+        NodeArena *const arena;
+        NodeArena *const interleavedArena;
+        char *chunkCursor = nullptr;
+        char *chunkEnd = nullptr;
+
+        void *allocateFromArena(std::size_t size);
+
+        /**
+         * the class of the size, nullptr if all classes are taken by other sizes
+         */
+        NodeClass *getNodeClass(std::size_t size);
+
     public:
-        std::atomic<uint64_t> localEpoche;
+        /**
+         * the NUMA node of the thread that acquired the slot
+         */
+        const unsigned numaNode;
+
         size_t thresholdCounter{0};
 
+        /**
+         * bytes of the nodes in the list, only written by the owner
+         */
+        std::atomic<std::size_t> pendingBytes{0};
+
+        /**
+         * keeps up to maxFreeNodes reclaimed nodes per size for reuse, with an arena the others are pooled there
+         */
+        DeletionList(unsigned numaNode = 0, NodeArena *arena = nullptr, NodeArena *interleavedArena = nullptr,
+                     uint32_t maxFreeNodes = 512)
+                : maxFreeNodes(maxFreeNodes), arena(arena), interleavedArena(interleavedArena), numaNode(numaNode) { }
+
         ~DeletionList();
         LabelDelete *head();
 
-        void add(void *n, uint64_t globalEpoch);
+        void add(void *n, std::size_t size, uint64_t globalEpoch);
 
         void remove(LabelDelete *label, LabelDelete *prev);
 
         std::size_t size();
 
+        /**
+         * detaches all labels from the list and returns them as a chain
+         */
+        LabelDelete *takeAll();
+
+        /**
+         * takes over a chain of labels detached from another list
+         */
+        void adopt(LabelDelete *labels);
+
+        /**
+         * reuses a reclaimed node of the given size if there is one, interleaved nodes are always new
+         */
+        void *allocateNode(std::size_t size, bool interleaved);
+
+        /**
+         * keeps the node for reuse if there is room for it, frees it otherwise
+         */
+        void reclaimNode(void *n, std::size_t size);
+
+        /**
+         * reclaims a node right away that has never been reachable by other threads
+         */
+        void discardNode(void *n, std::size_t size);
+
+        /**
+         * adds the bytes per node size of this list to the usage
+         */
+        void addMemoryUsage(MemoryUsage &usage) const;
+
         std::uint64_t deleted = 0;
         std::uint64_t added = 0;
     };
@@ -40,6 +190,16 @@ namespace ART {
     class Epoche;
     class EpocheGuard;
 
+    enum class ReclamationMode : uint8_t {
+        // the worker that crosses the threshold frees the nodes itself
+        Inline,
+        // workers hand their nodes over to a reclaimer thread that advances the epoche and frees them
+        Background,
+        // threads stay in the epoche between operations and only leave it when they announce a quiescent
+        // state with Epoche::quiescentState(), operations do not store anything in the slot
+        Quiescent
+    };
+
     class ThreadInfo {
         friend class Epoche;
         friend class EpocheGuard;
@@ -55,33 +215,241 @@ namespace ART {
         ThreadInfo(const ThreadInfo &ti) : epoche(ti.epoche), deletionList(ti.deletionList) {
         }
 
+        /**
+         * hands the nodes this thread marked for deletion over to the other threads of the Epoche
+         */
         ~ThreadInfo();
 
         Epoche & getEpoche() const;
+
+        std::size_t getPendingBytes() const;
+    };
+
+    /**
+     * ids of all living Epoches, lets exiting threads find out whether the Epoche they registered at
+     * still exists. Guards thread registration at every Epoche.
+     */
+    struct EpocheRegistry {
+        std::mutex mutex;
+        std::unordered_set<uint64_t> alive;
+        uint64_t nextId = 0;
+
+        static EpocheRegistry &get();
+    };
+
+    /**
+     * the slots the current thread holds, released when the thread exits
+     */
+    class ThreadSlots {
+        struct Entry {
+            uint64_t epocheId;
+            Epoche *epoche;
+            DeletionList *deletionList;
+        };
+        std::vector<Entry> entries;
+
+    public:
+        static ThreadSlots &local();
+
+        DeletionList &get(Epoche &epoche);
+
+        ~ThreadSlots();
     };
 
     class Epoche {
         friend class ThreadInfo;
+        friend class ThreadSlots;
         std::atomic<uint64_t> currentEpoche{0};
 
-        tbb::enumerable_thread_specific<DeletionList> deletionLists;
+        /**
+         * A copy of currentEpoche per NUMA node that the threads of the node announce, it lags behind and
+         * readers keep their lines local. A node only advances currentEpoche if no other node did since it
+         * took over the last value, requests of several nodes are combined into one advance. Nodes are
+         * labelled with currentEpoche itself, an announced copy is never ahead of it.
+         */
+        struct alignas(64) SocketEpoche {
+            std::atomic<uint64_t> epoche{0};
+        };
+        const NumaTopology &topology;
+        SocketEpoche *socketEpoches;
+
+        /**
+         * one padded slot per registered thread, slots below usedSlots have been handed out at least once
+         * and are scanned by the garbage collection, released slots are reused before new ones. The slot
+         * after the last thread slot counts the nodes freed by the reclaimer thread and keeps none of them.
+         */
+        DeletionList *deletionLists;
+        std::atomic<std::size_t> usedSlots{0};
+        std::vector<std::size_t> freeSlots;
+        const std::size_t maxThreads;
+        uint64_t id;
 
         size_t startGCThreshhold;
 
+        const ReclamationMode reclamationMode;
+
+        const NodeAllocator nodeAllocator;
+
+        /**
+         * one arena per NUMA node for NumaArena, a single one for HugePageArena, none for Heap
+         */
+        std::vector<std::unique_ptr<NodeArena>> arenas;
+        std::unique_ptr<NodeArena> interleavedArena;
+
+        /**
+         * labels that no thread owns anymore, either handed over to the reclaimer thread or left behind by
+         * ThreadInfos that have been destroyed. Taken by the reclaimer or adopted by the next thread that
+         * collects garbage.
+         */
+        std::atomic<LabelDelete *> retiredLabels{nullptr};
+        std::atomic<std::size_t> retiredBytes{0};
+
+        /**
+         * upper bound for the bytes waiting for reclamation, 0 if unbounded
+         */
+        std::atomic<std::size_t> pendingBudget{0};
+        std::atomic<bool> stopReclaimer{false};
+        std::thread reclaimer;
+
+
+        uint64_t getOldestEpoche() const;
+
+        /**
+         * advances currentEpoche unless another NUMA node has done so since the node of the thread took over
+         * the last value
+         */
+        void advanceEpoche(DeletionList &deletionList);
+
+        /**
+         * brings the copies of all NUMA nodes up to date
+         */
+        void publishEpoche();
+
+        NodeArena *getArena(unsigned numaNode) const;
+
+        void retire(LabelDelete *labels);
+
+        LabelDelete *takeRetired();
+
+        void reclaim();
+
+        /**
+         * adopts the retired labels and frees all nodes of the list no thread can still access, into the
+         * freelists of the list as long as they have room
+         */
+        void cleanup(DeletionList &deletionList);
+
+        /**
+         * lets a writer help and wait for a limited time while the pending bytes exceed the budget
+         */
+        void applyBackpressure(DeletionList &deletionList);
+
+        /**
+         * prefers released slots of the NUMA node of the calling thread, can only be called while holding the
+         * registry mutex
+         */
+        DeletionList *acquireSlot();
+
+        /**
+         * can only be called while holding the registry mutex
+         */
+        void releaseSlot(DeletionList *deletionList);
 
     public:
-        Epoche(size_t startGCThreshhold) : startGCThreshhold(startGCThreshhold) { }
+        Epoche(size_t startGCThreshhold, ReclamationMode reclamationMode = ReclamationMode::Inline,
+               NodeAllocator nodeAllocator = NodeAllocator::Heap, size_t maxThreads = 1024);
+
+        Epoche(const Epoche &) = delete;
 
         ~Epoche();
 
         void enterEpoche(ThreadInfo &epocheInfo);
 
-        void markNodeForDeletion(void *n, ThreadInfo &epocheInfo);
+        void markNodeForDeletion(void *n, std::size_t size, ThreadInfo &epocheInfo);
+
+        /**
+         * levels of the tree above this depth are interleaved over the NUMA nodes with NumaArena
+         */
+        static constexpr uint32_t interleavedDepth = 2;
+
+        /**
+         * memory for a new node at the given depth of the tree, the root is at depth 0. Reuses a node of the
+         * same size reclaimed by this thread if there is one.
+         */
+        void *allocateNode(std::size_t size, uint32_t depth, ThreadInfo &epocheInfo);
+
+        /**
+         * frees a node that no other thread has seen, e.g. when an operation has to restart after allocating it
+         */
+        void freeNode(void *n, std::size_t size, ThreadInfo &epocheInfo);
+
+        /**
+         * bytes per node size summed over all threads, the counters are read without synchronization and the
+         * result is a close estimate while other threads modify the tree
+         */
+        MemoryUsage getMemoryUsage() const;
 
         void exitEpocheAndCleanup(ThreadInfo &info);
 
+        /**
+         * readers stay in their last epoche unless the memory is bounded
+         */
+        void exitEpocheReadonly(ThreadInfo &info);
+
+        /**
+         * Quiescent mode only: the thread holds no node it has read before, nodes retired until now can be
+         * freed once all other threads have passed a quiescent state as well. Collects garbage if enough
+         * has piled up.
+         */
+        void quiescentState(ThreadInfo &info);
+
+        /**
+         * Quiescent mode only: the thread does not use the tree until its next operation, e.g. while it waits
+         * for requests, and does not hold back reclamation meanwhile
+         */
+        void goOffline(ThreadInfo &info);
+
+        ReclamationMode getReclamationMode() const;
+
+        NodeAllocator getNodeAllocator() const;
+
+        /**
+         * the arena of the NUMA node, nullptr unless nodes are allocated from an arena
+         */
+        const NodeArena *getNodeArena(unsigned numaNode = 0) const;
+
+        /**
+         * the arena of the top levels, nullptr unless nodes are allocated with NumaArena
+         */
+        const NodeArena *getInterleavedArena() const;
+
+        const NumaTopology &getTopology() const;
+
         void showDeleteRatio();
 
+        /**
+         * bytes marked for deletion but not yet freed, one entry per thread slot
+         */
+        std::vector<std::size_t> getPendingBytesPerThread() const;
+
+        /**
+         * bytes marked for deletion that no thread owns anymore
+         */
+        std::size_t getRetiredBytes() const;
+
+        std::size_t getPendingBytes() const;
+
+        /**
+         * Bounds the bytes waiting for reclamation, 0 removes the bound. In bounded mode readers leave the
+         * epoche after every lookup, range scans leave and re-enter it between chunks while the budget is
+         * exceeded and writers are slowed down until the budget is met again.
+         */
+        void setPendingBudget(std::size_t bytes);
+
+        bool isBounded() const;
+
+        bool isOverBudget() const;
+
     };
 
     class EpocheGuard {
@@ -98,19 +466,74 @@ namespace ART {
     };
 
     class EpocheGuardReadonly {
+        ThreadInfo &threadEpocheInfo;
     public:
 
-        EpocheGuardReadonly(ThreadInfo &threadEpocheInfo) {
+        EpocheGuardReadonly(ThreadInfo &threadEpocheInfo) : threadEpocheInfo(threadEpocheInfo) {
             threadEpocheInfo.getEpoche().enterEpoche(threadEpocheInfo);
         }
 
         ~EpocheGuardReadonly() {
+            threadEpocheInfo.getEpoche().exitEpocheReadonly(threadEpocheInfo);
+        }
+    };
+
+    /**
+     * Keeps the thread inside the epoche across many operations, pass it to the session overloads of the
+     * trees. Nodes removed during the session are only reclaimed once the session is refreshed or closed,
+     * long running sessions should call refresh() regularly, e.g. every few thousand operations.
+     */
+    class EpocheSession {
+        ThreadInfo &threadEpocheInfo;
+        // changes with every refresh, unique among the sessions of a thread
+        uint64_t id;
+
+        static uint64_t nextId() {
+            static thread_local uint64_t lastId = 0;
+            return ++lastId;
+        }
+    public:
+
+        EpocheSession(ThreadInfo &threadEpocheInfo) : threadEpocheInfo(threadEpocheInfo), id(nextId()) {
+            threadEpocheInfo.getEpoche().enterEpoche(threadEpocheInfo);
+        }
+
+        EpocheSession(const EpocheSession &) = delete;
+
+        ~EpocheSession() {
+            threadEpocheInfo.getEpoche().exitEpocheAndCleanup(threadEpocheInfo);
+        }
+
+        /**
+         * leaves the epoche, collects garbage if enough has piled up and enters again, no node read
+         * before may be used afterwards
+         */
+        void refresh() {
+            Epoche &epoche = threadEpocheInfo.getEpoche();
+            id = nextId();
+            if (epoche.getReclamationMode() == ReclamationMode::Quiescent) {
+                epoche.quiescentState(threadEpocheInfo);
+                return;
+            }
+            epoche.exitEpocheAndCleanup(threadEpocheInfo);
+            epoche.enterEpoche(threadEpocheInfo);
+        }
+
+        ThreadInfo &getThreadInfo() const {
+            return threadEpocheInfo;
+        }
+
+        /**
+         * nodes read by the thread under the same id are still safe to access
+         */
+        uint64_t getId() const {
+            return id;
         }
     };
 
-    inline ThreadInfo::~ThreadInfo() {
-        deletionList.localEpoche.store(std::numeric_limits<uint64_t>::max());
-    }
 }
 
+// all definitions are inline, including them here lets code outside of the trees open sessions
+#include "Epoche.cpp"
+
 #endif //ART_EPOCHE_H
@@ -98,6 +98,11 @@ public:
 
     const uint8_t* getData() const { return data; }
 
+    /**
+     * 8 bits of a hash over the whole key, never 0
+     */
+    uint8_t getFingerprint() const;
+
 };
 
 
@@ -113,6 +118,24 @@ inline const uint8_t &Key::operator[](std::size_t i) const {
 
 inline KeyLen Key::getKeyLen() const { return len; }
 
+inline uint8_t Key::getFingerprint() const {
+    uint64_t hash = len;
+    KeyLen i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ul;
+        hash ^= hash >> 32;
+    }
+    uint64_t word = 0;
+    if (i < len) {
+        memcpy(&word, data + i, len - i);
+    }
+    hash = (hash ^ word) * 0x9E3779B97F4A7C15ul;
+    uint8_t fingerprint = static_cast<uint8_t>(hash >> 56);
+    return fingerprint != 0 ? fingerprint : 1;
+}
+
 inline Key::~Key() {
     if (len > stackLen) {
         delete[] data;
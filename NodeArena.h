@@ -0,0 +1,234 @@
+#ifndef ART_NODEARENA_H
+#define ART_NODEARENA_H
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include "NumaTopology.h"
+#include "CompressedPointers.h"
+
+namespace ART {
+
+    enum class NodeAllocator : uint8_t {
+        // every node is allocated with operator new
+        Heap,
+        // nodes are cut from 2 MB chunks backed by huge pages, the memory is only returned when the tree goes away
+        HugePageArena,
+        // like HugePageArena with one arena per NUMA node, a thread allocates on its own node and the top
+        // levels of the tree are interleaved over all nodes
+        NumaArena
+    };
+
+    /**
+     * Hands out 2 MB aligned chunks from large mappings, each thread cuts its nodes from its own chunk. The
+     * mappings use huge pages from hugetlbfs if the system has reserved some and are advised to be backed by
+     * transparent huge pages otherwise. Nodes that threads cannot keep in their own freelists are pooled here
+     * per size for the other threads. With a topology the mappings are placed on a single NUMA node or
+     * interleaved over all of them. With compressed pointers the mappings are cut from the CompressedRegion.
+     */
+    class NodeArena {
+    public:
+        static constexpr std::size_t chunkSize = 2 * 1024 * 1024;
+        static constexpr std::size_t chunksPerMapping = 32;
+
+    private:
+        struct Pool {
+            std::size_t size = 0;
+            void *head = nullptr;
+        };
+
+        std::mutex mutex;
+        std::vector<std::pair<void *, std::size_t>> mappings;
+        char *nextChunk = nullptr;
+        char *mappingEnd = nullptr;
+        // one per node size like the node classes of the epoche
+        std::array<Pool, 12> pools;
+        std::atomic<std::size_t> mappedBytes{0};
+        std::atomic<std::size_t> hugetlbBytes{0};
+        std::atomic<std::size_t> placedBytes{0};
+
+        const NumaTopology *const topology;
+        const int numaNode;
+
+        /**
+         * the part of the current chunk not handed out by allocate()
+         */
+        char *cursor = nullptr;
+        char *end = nullptr;
+
+        void place(void *p, std::size_t length) {
+            if (topology == nullptr || topology->isSimulated()) {
+                return;
+            }
+            unsigned long mask[16] = {};
+            const unsigned long maskBits = sizeof(mask) * 8;
+            int mode = MPOL_INTERLEAVE;
+            if (numaNode >= 0) {
+                // preferred instead of bound, a full node falls back to the others
+                mode = MPOL_PREFERRED;
+                unsigned long id = topology->getNodeId(numaNode);
+                mask[id / 64] |= 1ul << (id % 64);
+            } else {
+                for (unsigned n = 0; n < topology->getNodeCount(); ++n) {
+                    unsigned long id = topology->getNodeId(n);
+                    mask[id / 64] |= 1ul << (id % 64);
+                }
+            }
+            // the kernel reads one bit less than maxnode
+            if (syscall(SYS_mbind, p, length, mode, mask, maskBits + 1, 0) == 0) {
+                placedBytes += length;
+            }
+        }
+
+        void map() {
+            const std::size_t length = chunkSize * chunksPerMapping;
+#ifdef ART_COMPRESSED_POINTERS
+            // the nodes have to stay within the region to be referenced by offset
+            nextChunk = CompressedRegion::get().allocateSpan(length, chunkSize);
+            mappings.emplace_back(nextChunk, length);
+            place(nextChunk, length);
+            mappingEnd = nextChunk + length;
+            mappedBytes += length;
+            return;
+#endif
+            // reserves the huge pages up front, fails instead of faulting later if there are not enough
+            void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                mappings.emplace_back(p, length);
+                hugetlbBytes += length;
+                nextChunk = static_cast<char *>(p);
+                place(p, length);
+            } else {
+                // one chunk more to align the start to a huge page
+                p = mmap(nullptr, length + chunkSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                if (p == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+                mappings.emplace_back(p, length + chunkSize);
+                uintptr_t start = (reinterpret_cast<uintptr_t>(p) + chunkSize - 1) & ~(chunkSize - 1);
+                nextChunk = reinterpret_cast<char *>(start);
+                place(nextChunk, length);
+#ifdef MADV_HUGEPAGE
+                madvise(nextChunk, length, MADV_HUGEPAGE);
+#endif
+            }
+            mappingEnd = nextChunk + length;
+            mappedBytes += length;
+        }
+
+        char *takeChunk() {
+            if (nextChunk == mappingEnd) {
+                map();
+            }
+            char *chunk = nextChunk;
+            nextChunk += chunkSize;
+            return chunk;
+        }
+
+    public:
+        /**
+         * places the memory on numaNode of the topology, interleaves it over all nodes if numaNode is
+         * negative and leaves it to the system without a topology
+         */
+        NodeArena(const NumaTopology *topology = nullptr, int numaNode = -1)
+                : topology(topology), numaNode(numaNode) { }
+
+        NodeArena(const NodeArena &) = delete;
+
+        ~NodeArena() {
+            for (auto &m : mappings) {
+#ifdef ART_COMPRESSED_POINTERS
+                CompressedRegion::get().releaseSpan(static_cast<char *>(m.first), m.second);
+#else
+                munmap(m.first, m.second);
+#endif
+            }
+        }
+
+        /**
+         * a new chunk of chunkSize bytes, aligned to chunkSize
+         */
+        char *allocateChunk() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return takeChunk();
+        }
+
+        /**
+         * a node cut from a chunk shared by all threads, for nodes that are allocated rarely
+         */
+        void *allocate(std::size_t size) {
+            std::size_t alignedSize = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (static_cast<std::size_t>(end - cursor) < alignedSize) {
+                cursor = takeChunk();
+                end = cursor + chunkSize;
+            }
+            void *n = cursor;
+            cursor += alignedSize;
+            return n;
+        }
+
+        /**
+         * pools a node for other threads, false if all pools are taken by other sizes
+         */
+        bool release(void *n, std::size_t size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &p : pools) {
+                if (p.size == 0) {
+                    p.size = size;
+                }
+                if (p.size == size) {
+                    *static_cast<void **>(n) = p.head;
+                    p.head = n;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * a pooled node of the given size or nullptr
+         */
+        void *takeReleased(std::size_t size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &p : pools) {
+                if (p.size == size && p.head != nullptr) {
+                    void *n = p.head;
+                    p.head = *static_cast<void **>(n);
+                    return n;
+                }
+            }
+            return nullptr;
+        }
+
+        std::size_t getMappedBytes() const {
+            return mappedBytes.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * the part of the mapped bytes backed by hugetlbfs, the rest relies on transparent huge pages
+         */
+        std::size_t getHugetlbBytes() const {
+            return hugetlbBytes.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * the part of the mapped bytes with a NUMA policy, 0 in a simulated topology
+         */
+        std::size_t getPlacedBytes() const {
+            return placedBytes.load(std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif //ART_NODEARENA_H
@@ -0,0 +1,285 @@
+#ifndef ART_NODESEARCH_H
+#define ART_NODESEARCH_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace ART {
+
+    /**
+     * The searches over the key bytes of the nodes. The N16 and N32 kernels compare all keys at once and are
+     * inlined, N16 uses SSE2, which every x86-64 CPU has, N32 one AVX2 compare if the build targets AVX2 and two
+     * SSE2 compares otherwise. N4 compares its four keys in one SSE2 register, which saves the mispredicted
+     * branches of the loop, except in ROWEX, whose keys are atomics of their own. The child index
+     * of N48 is scanned 64 bytes at a time with a scalar, SSE2, AVX2 or AVX-512 kernel, the widest one the CPU
+     * supports is picked once from CPUID. The default build, without -march=native, therefore runs on every x86-64
+     * host and still uses AVX-512 where it is available. Setting ART_NODE_SEARCH=scalar|sse2|avx2|avx512 in the
+     * environment picks a narrower kernel. mismatch compares the prefixes of the inner nodes with the searched
+     * key, it is inlined and uses the widest vectors the build targets.
+     */
+    class NodeSearch {
+    public:
+        using NonEmptyMask = uint64_t (*)(const uint8_t *bytes, uint8_t emptyMarker);
+
+        struct Kernel {
+            const char *name;
+            // bit i set if bytes[i] != emptyMarker, for 64 bytes
+            NonEmptyMask nonEmptyMask64;
+        };
+
+        static uint64_t nonEmptyMask64Scalar(const uint8_t *bytes, uint8_t emptyMarker) {
+            uint64_t mask = 0;
+            for (unsigned i = 0; i < 64; ++i) {
+                mask |= static_cast<uint64_t>(bytes[i] != emptyMarker) << i;
+            }
+            return mask;
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        static uint64_t nonEmptyMask64Sse2(const uint8_t *bytes, uint8_t emptyMarker) {
+            const __m128i empty = _mm_set1_epi8(emptyMarker);
+            uint64_t mask = 0;
+            for (unsigned i = 0; i < 64; i += 16) {
+                __m128i cmp = _mm_cmpeq_epi8(empty, _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i)));
+                mask |= static_cast<uint64_t>(static_cast<uint16_t>(~_mm_movemask_epi8(cmp))) << i;
+            }
+            return mask;
+        }
+
+        __attribute__((target("avx2")))
+        static uint64_t nonEmptyMask64Avx2(const uint8_t *bytes, uint8_t emptyMarker) {
+            const __m256i empty = _mm256_set1_epi8(emptyMarker);
+            __m256i low = _mm256_cmpeq_epi8(empty, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes)));
+            __m256i high = _mm256_cmpeq_epi8(empty,
+                                             _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + 32)));
+            return ~(static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(low))) |
+                     static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32);
+        }
+
+        __attribute__((target("avx512bw")))
+        static uint64_t nonEmptyMask64Avx512(const uint8_t *bytes, uint8_t emptyMarker) {
+            return _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(bytes), _mm512_set1_epi8(emptyMarker));
+        }
+#endif
+
+        /**
+         * all kernels the CPU can run, the widest last
+         */
+        static std::vector<Kernel> getSupportedKernels() {
+            std::vector<Kernel> kernels{{"scalar", nonEmptyMask64Scalar}};
+#if defined(__x86_64__) || defined(__i386__)
+            kernels.push_back({"sse2", nonEmptyMask64Sse2});
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                kernels.push_back({"avx2", nonEmptyMask64Avx2});
+            }
+            if (__builtin_cpu_supports("avx512bw")) {
+                kernels.push_back({"avx512", nonEmptyMask64Avx512});
+            }
+#endif
+            return kernels;
+        }
+
+        /**
+         * the kernel used by the nodes, chosen on first use
+         */
+        static const Kernel &getKernel() {
+            static const Kernel kernel = []() {
+                auto kernels = getSupportedKernels();
+                const char *name = getenv("ART_NODE_SEARCH");
+                for (auto &k : kernels) {
+                    if (name != nullptr && std::string(name) == k.name) {
+                        return k;
+                    }
+                }
+                return kernels.back();
+            }();
+            return kernel;
+        }
+
+        /**
+         * bit i set if keys[i] == key, for 4 bytes
+         */
+        static uint32_t equalMask4(const uint8_t *keys, uint8_t key) {
+            int32_t word;
+            memcpy(&word, keys, sizeof(word));
+#ifdef __SSE2__
+            __m128i cmp = _mm_cmpeq_epi8(_mm_cvtsi32_si128(word), _mm_set1_epi8(key));
+            return static_cast<uint32_t>(_mm_movemask_epi8(cmp)) & 0xF;
+#else
+            uint32_t mask = 0;
+            for (unsigned i = 0; i < 4; ++i) {
+                mask |= static_cast<uint32_t>(keys[i] == key) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * bit i set if keys[i] == key, for 16 bytes
+         */
+        static uint32_t equalMask16(const uint8_t *keys, uint8_t key) {
+#ifdef __SSE2__
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(key), _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
+            return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+            uint32_t mask = 0;
+            for (unsigned i = 0; i < 16; ++i) {
+                mask |= static_cast<uint32_t>(keys[i] == key) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * bit i set if keys[i] > key compared as signed bytes, for 16 bytes. N16 flips the sign bit of its keys
+         * so that this is the order of the unsigned key bytes.
+         */
+        static uint32_t greaterMask16(const uint8_t *keys, uint8_t key) {
+#ifdef __SSE2__
+            __m128i cmp = _mm_cmplt_epi8(_mm_set1_epi8(key), _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
+            return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+            uint32_t mask = 0;
+            for (unsigned i = 0; i < 16; ++i) {
+                mask |= static_cast<uint32_t>(static_cast<int8_t>(keys[i]) > static_cast<int8_t>(key)) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * bit i set if start <= keys[i] <= end compared as signed bytes, for 16 bytes
+         */
+        static uint32_t rangeMask16(const uint8_t *keys, uint8_t start, uint8_t end) {
+#ifdef __SSE2__
+            __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+            __m128i outside = _mm_or_si128(_mm_cmplt_epi8(k, _mm_set1_epi8(start)),
+                                           _mm_cmpgt_epi8(k, _mm_set1_epi8(end)));
+            return static_cast<uint16_t>(~_mm_movemask_epi8(outside));
+#else
+            uint32_t mask = 0;
+            for (unsigned i = 0; i < 16; ++i) {
+                int8_t k = static_cast<int8_t>(keys[i]);
+                mask |= static_cast<uint32_t>(k >= static_cast<int8_t>(start) && k <= static_cast<int8_t>(end)) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /**
+         * equalMask16 for 32 bytes
+         */
+        static uint32_t equalMask32(const uint8_t *keys, uint8_t key) {
+#ifdef __AVX2__
+            __m256i cmp = _mm256_cmpeq_epi8(_mm256_set1_epi8(key),
+                                            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys)));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+#else
+            return equalMask16(keys, key) | equalMask16(keys + 16, key) << 16;
+#endif
+        }
+
+        /**
+         * greaterMask16 for 32 bytes
+         */
+        static uint32_t greaterMask32(const uint8_t *keys, uint8_t key) {
+#ifdef __AVX2__
+            __m256i cmp = _mm256_cmpgt_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys)),
+                                            _mm256_set1_epi8(key));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+#else
+            return greaterMask16(keys, key) | greaterMask16(keys + 16, key) << 16;
+#endif
+        }
+
+        /**
+         * rangeMask16 for 32 bytes
+         */
+        static uint32_t rangeMask32(const uint8_t *keys, uint8_t start, uint8_t end) {
+#ifdef __AVX2__
+            __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(start), k),
+                                              _mm256_cmpgt_epi8(k, _mm256_set1_epi8(end)));
+            return ~static_cast<uint32_t>(_mm256_movemask_epi8(outside));
+#else
+            return rangeMask16(keys, start, end) | rangeMask16(keys + 16, start, end) << 16;
+#endif
+        }
+
+        /**
+         * calls fn(i) in order for the bits start <= i <= end that are set in a bitmap of 256 bits, stops when
+         * fn returns false. Word is uint64_t or an atomic of it.
+         */
+        template<typename Word, typename Fn>
+        static void forEachBit256(const Word *bitmap, unsigned start, unsigned end, Fn fn) {
+            for (unsigned w = start / 64; w <= end / 64; ++w) {
+                uint64_t mask = bitmap[w];
+                if (w == start / 64) {
+                    mask &= ~0ull << (start % 64);
+                }
+                if (w == end / 64) {
+                    mask &= ~0ull >> (63 - end % 64);
+                }
+                for (; mask != 0; mask &= mask - 1) {
+                    if (!fn(w * 64 + __builtin_ctzll(mask))) {
+                        return;
+                    }
+                }
+            }
+        }
+
+
+        /**
+         * the position of the first byte in which a and b differ, len if they are equal. Compares 32 or 16 bytes
+         * at a time and the rest in words, never reads past len.
+         */
+        static uint32_t mismatch(const uint8_t *a, const uint8_t *b, uint32_t len) {
+            uint32_t i = 0;
+#ifdef __AVX2__
+            for (; i + 32 <= len; i += 32) {
+                __m256i cmp = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+                uint32_t differ = ~static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+                if (differ != 0) {
+                    return i + __builtin_ctz(differ);
+                }
+            }
+#endif
+#ifdef __SSE2__
+            for (; i + 16 <= len; i += 16) {
+                __m128i cmp = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+                uint32_t differ = static_cast<uint16_t>(~_mm_movemask_epi8(cmp));
+                if (differ != 0) {
+                    return i + __builtin_ctz(differ);
+                }
+            }
+#endif
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            for (; i + 8 <= len; i += 8) {
+                uint64_t wordA, wordB;
+                memcpy(&wordA, a + i, sizeof(wordA));
+                memcpy(&wordB, b + i, sizeof(wordB));
+                if (wordA != wordB) {
+                    return i + __builtin_ctzll(wordA ^ wordB) / 8;
+                }
+            }
+#endif
+            for (; i < len; ++i) {
+                if (a[i] != b[i]) {
+                    return i;
+                }
+            }
+            return len;
+        }
+    };
+}
+
+#endif //ART_NODESEARCH_H
@@ -0,0 +1,166 @@
+#ifndef ART_NUMATOPOLOGY_H
+#define ART_NUMATOPOLOGY_H
+
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ART {
+
+    /**
+     * The NUMA nodes of the machine and their CPUs as listed in sysfs, nodes are numbered densely from 0.
+     * Setting ART_NUMA_NODES=n in the environment simulates n nodes instead: the CPUs are split into n
+     * consecutive groups, nodes left without a CPU share one with the others. Memory is not placed on a
+     * simulated node, everything else behaves as on a NUMA machine.
+     */
+    class NumaTopology {
+        std::vector<int> nodeIds;
+        std::vector<std::vector<unsigned>> nodeCpus;
+        std::vector<unsigned> cpuNodes;
+        bool simulated = false;
+
+        static int &pinnedNode() {
+            static thread_local int node = -1;
+            return node;
+        }
+
+        /**
+         * parses a list like "0-3,8-11"
+         */
+        static std::vector<unsigned> parseList(const std::string &list) {
+            std::vector<unsigned> values;
+            std::stringstream ranges(list);
+            std::string range;
+            while (std::getline(ranges, range, ',')) {
+                if (range.empty() || range[0] < '0' || range[0] > '9') {
+                    continue;
+                }
+                std::size_t dash = range.find('-');
+                unsigned first = std::stoul(range.substr(0, dash));
+                unsigned last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for (unsigned v = first; v <= last; ++v) {
+                    values.push_back(v);
+                }
+            }
+            return values;
+        }
+
+        static std::string readLine(const std::string &path) {
+            std::ifstream in(path);
+            std::string line;
+            std::getline(in, line);
+            return line;
+        }
+
+        void addNode(int id, std::vector<unsigned> cpus) {
+            for (unsigned cpu : cpus) {
+                if (cpuNodes.size() <= cpu) {
+                    cpuNodes.resize(cpu + 1, 0);
+                }
+                cpuNodes[cpu] = nodeIds.size();
+            }
+            nodeIds.push_back(id);
+            nodeCpus.push_back(std::move(cpus));
+        }
+
+    public:
+        static NumaTopology detect() {
+            NumaTopology topology;
+            for (unsigned id : parseList(readLine("/sys/devices/system/node/online"))) {
+                auto cpus = parseList(readLine("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist"));
+                // memory-only nodes get no threads
+                if (!cpus.empty()) {
+                    topology.addNode(id, std::move(cpus));
+                }
+            }
+            if (topology.nodeIds.empty()) {
+                return simulate(1);
+            }
+            return topology;
+        }
+
+        static NumaTopology simulate(unsigned nodes) {
+            NumaTopology topology;
+            topology.simulated = true;
+            unsigned cpus = std::max(1l, sysconf(_SC_NPROCESSORS_ONLN));
+            nodes = std::max(1u, nodes);
+            for (unsigned n = 0; n < nodes; ++n) {
+                std::vector<unsigned> nodeCpus;
+                for (unsigned cpu = n * cpus / nodes; cpu < (n + 1) * cpus / nodes; ++cpu) {
+                    nodeCpus.push_back(cpu);
+                }
+                if (nodeCpus.empty()) {
+                    nodeCpus.push_back(n % cpus);
+                }
+                topology.addNode(n, std::move(nodeCpus));
+            }
+            return topology;
+        }
+
+        /**
+         * the topology of the machine, or the simulated one if ART_NUMA_NODES is set, read once
+         */
+        static const NumaTopology &get() {
+            static const NumaTopology topology = []() {
+                const char *nodes = getenv("ART_NUMA_NODES");
+                return nodes != nullptr ? simulate(std::atoi(nodes)) : detect();
+            }();
+            return topology;
+        }
+
+        unsigned getNodeCount() const {
+            return nodeIds.size();
+        }
+
+        bool isSimulated() const {
+            return simulated;
+        }
+
+        /**
+         * the number the operating system uses for the node
+         */
+        int getNodeId(unsigned node) const {
+            return nodeIds[node];
+        }
+
+        const std::vector<unsigned> &getCpus(unsigned node) const {
+            return nodeCpus[node];
+        }
+
+        /**
+         * the node the calling thread has been pinned to, the node of the CPU it runs on otherwise
+         */
+        unsigned getCurrentNode() const {
+            int pinned = pinnedNode();
+            if (pinned >= 0 && static_cast<unsigned>(pinned) < getNodeCount()) {
+                return pinned;
+            }
+            int cpu = sched_getcpu();
+            return cpu >= 0 && static_cast<unsigned>(cpu) < cpuNodes.size() ? cpuNodes[cpu] : 0;
+        }
+
+        /**
+         * restricts the calling thread to the CPUs of the node, the node counts as the thread's own even
+         * if it shares its CPUs in a simulated topology
+         */
+        bool pinThread(unsigned node) const {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (unsigned cpu : nodeCpus[node]) {
+                CPU_SET(cpu, &set);
+            }
+            if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+                return false;
+            }
+            pinnedNode() = node;
+            return true;
+        }
+    };
+}
+
+#endif //ART_NUMATOPOLOGY_H
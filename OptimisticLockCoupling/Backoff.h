@@ -0,0 +1,71 @@
+//
+// Backoff policies for the optimistic version locks of ART_OLC.
+//
+
+#ifndef ART_OPTIMISTIC_LOCK_COUPLING_BACKOFF_H
+#define ART_OPTIMISTIC_LOCK_COUPLING_BACKOFF_H
+
+#include <stdint.h>
+#include <thread>
+#include <emmintrin.h> // _mm_pause
+
+namespace ART_OLC {
+    /*
+     * A policy decides what a thread does when it finds a node locked or has to restart an operation.
+     * spin(attempt) is called for the attempt-th consecutive failure, starting at 1.
+     * waitsForLocks selects whether a read lock waits for the writer to finish or restarts immediately.
+     */
+
+    /**
+     * restarts immediately and never pauses, the original behavior
+     */
+    struct NoBackoff {
+        static constexpr bool waitsForLocks = false;
+
+        static void spin(uint32_t) { }
+    };
+
+    /**
+     * waits for locked nodes with one pause instruction per check
+     */
+    struct PauseSpin {
+        static constexpr bool waitsForLocks = true;
+
+        static void spin(uint32_t) {
+            _mm_pause();
+        }
+    };
+
+    /**
+     * doubles the number of pause instructions with every failure up to maxPauses
+     */
+    struct ExponentialBackoff {
+        static constexpr bool waitsForLocks = true;
+        static constexpr uint32_t maxPauses = 1024;
+
+        static void spin(uint32_t attempt) {
+            uint32_t pauses = attempt < 11 ? (1u << (attempt - 1)) : maxPauses;
+            for (uint32_t i = 0; i < pauses; ++i) {
+                _mm_pause();
+            }
+        }
+    };
+
+    /**
+     * pauses for the first spinLimit failures and then yields the core to other threads
+     */
+    struct SpinThenYield {
+        static constexpr bool waitsForLocks = true;
+        static constexpr uint32_t spinLimit = 64;
+
+        static void spin(uint32_t attempt) {
+            if (attempt <= spinLimit) {
+                _mm_pause();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+#endif //ART_OPTIMISTIC_LOCK_COUPLING_BACKOFF_H
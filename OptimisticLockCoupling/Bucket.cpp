@@ -0,0 +1,242 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_OLC {
+
+    static_assert(maxBucketSize < 32, "a split partitions maxBucketSize + 1 leaves under at most an N32");
+
+    std::size_t Bucket::getSize(uint32_t capacity) {
+        return sizeof(Bucket) + capacity * (sizeof(uint32_t) + sizeof(ChildRef<N>));
+    }
+
+    Bucket *Bucket::create(uint32_t capacity, uint32_t depth, ThreadInfo &threadInfo) {
+        void *memory = threadInfo.getEpoche().allocateNode(getSize(capacity), depth, threadInfo);
+        memset(static_cast<char *>(memory) + sizeof(Bucket), 0, getSize(capacity) - sizeof(Bucket));
+        return new(memory) Bucket(capacity);
+    }
+
+    uint32_t Bucket::getPartialKey(const Key &k, uint32_t level) {
+        uint32_t partialKey = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (level + sizeof(partialKey) <= k.getKeyLen()) {
+            memcpy(&partialKey, k.getData() + level, sizeof(partialKey));
+            return __builtin_bswap32(partialKey);
+        }
+#endif
+        for (uint32_t i = level; i < level + sizeof(partialKey); ++i) {
+            partialKey = partialKey << 8 | (i < k.getKeyLen() ? k.getData()[i] : 0);
+        }
+        return partialKey;
+    }
+
+    template<typename curN>
+    N *Bucket::buildInner(N *const leaves[], const Key keys[], uint32_t count, uint32_t level,
+                          uint32_t prefixLength, uint32_t depth, ThreadInfo &threadInfo) {
+        auto n = new(threadInfo.getEpoche().allocateNode(sizeof(curN), depth, threadInfo))
+                curN(keys[0].getData() + level, prefixLength);
+        uint32_t nodeLevel = level + prefixLength;
+        for (uint32_t i = 0, j; i < count; i = j) {
+            for (j = i + 1; j < count && keys[j][nodeLevel] == keys[i][nodeLevel]; ++j) { }
+            n->insert(keys[i][nodeLevel], build(leaves + i, keys + i, j - i, nodeLevel + 1, depth + 1, threadInfo));
+        }
+        return n;
+    }
+
+    N *Bucket::build(N *const leaves[], const Key keys[], uint32_t count, uint32_t level, uint32_t depth,
+                     ThreadInfo &threadInfo) {
+        if (count == 1) {
+            return leaves[0];
+        }
+        if (count <= maxBucketSize) {
+            uint32_t capacity = 2;
+            while (capacity < count) {
+                capacity *= 2;
+            }
+            auto b = create(capacity, depth, threadInfo);
+            for (uint32_t i = 0; i < count; ++i) {
+                b->insert(i, getPartialKey(keys[i], level), leaves[i]);
+            }
+            return b;
+        }
+        // the keys are sorted, all of them share the prefix of the first and the last one
+        uint32_t prefixLength = NodeSearch::mismatch(keys[0].getData() + level, keys[count - 1].getData() + level,
+                                                     std::min(keys[0].getKeyLen(), keys[count - 1].getKeyLen()) - level);
+        uint32_t nodeLevel = level + prefixLength;
+        uint32_t partitions = 1;
+        for (uint32_t i = 1; i < count; ++i) {
+            partitions += keys[i][nodeLevel] != keys[i - 1][nodeLevel];
+        }
+        if (partitions <= 4) {
+            return buildInner<N4>(leaves, keys, count, level, prefixLength, depth, threadInfo);
+        } else if (partitions <= 16) {
+            return buildInner<N16>(leaves, keys, count, level, prefixLength, depth, threadInfo);
+        }
+        return buildInner<N32>(leaves, keys, count, level, prefixLength, depth, threadInfo);
+    }
+
+    uint32_t *Bucket::getPartialKeys() {
+        return reinterpret_cast<uint32_t *>(this + 1);
+    }
+
+    const uint32_t *Bucket::getPartialKeys() const {
+        return reinterpret_cast<const uint32_t *>(this + 1);
+    }
+
+    ChildRef<N> *Bucket::getLeaves() {
+        return reinterpret_cast<ChildRef<N> *>(getPartialKeys() + capacity);
+    }
+
+    const ChildRef<N> *Bucket::getLeaves() const {
+        return reinterpret_cast<const ChildRef<N> *>(getPartialKeys() + capacity);
+    }
+
+    uint32_t Bucket::getCapacity() const {
+        return capacity;
+    }
+
+    bool Bucket::isFull() const {
+        return count == capacity;
+    }
+
+    bool Bucket::isUnderfull() const {
+        return capacity > 2 && count - 1u <= capacity / 4u;
+    }
+
+    uint32_t Bucket::lowerBound(uint32_t partialKey) const {
+        // readers may see count change, the version check discards what they found then
+        uint32_t entries = std::min<uint32_t>(count, capacity);
+        return static_cast<uint32_t>(std::lower_bound(getPartialKeys(), getPartialKeys() + entries, partialKey) -
+                                     getPartialKeys());
+    }
+
+    uint32_t Bucket::getInsertPosition(const Key &k, uint32_t level, void (*loadKey)(TID, Key &)) const {
+        uint32_t partialKey = getPartialKey(k, level);
+        uint32_t pos = lowerBound(partialKey);
+        for (; pos < count && getPartialKeys()[pos] == partialKey; ++pos) {
+            Key kt;
+            loadKey(N::getLeaf(getLeaves()[pos]), kt);
+            if (k < kt) {
+                break;
+            }
+        }
+        return pos;
+    }
+
+    void Bucket::insert(uint32_t pos, uint32_t partialKey, N *leaf) {
+        assert(count < capacity);
+        memmove(getPartialKeys() + pos + 1, getPartialKeys() + pos, (count - pos) * sizeof(uint32_t));
+        memmove(getLeaves() + pos + 1, getLeaves() + pos, (count - pos) * sizeof(ChildRef<N>));
+        getPartialKeys()[pos] = partialKey;
+        getLeaves()[pos] = leaf;
+        count++;
+    }
+
+    N *Bucket::grow(uint32_t pos, N *leaf, const Key &k, uint32_t level, void (*loadKey)(TID, Key &),
+                    uint32_t depth, ThreadInfo &threadInfo) const {
+        uint32_t bucketLevel = level + getPrefixLength();
+        if (capacity < maxBucketSize) {
+            auto b = create(capacity * 2, depth, threadInfo);
+            b->setPrefix(getPrefix(), getPrefixLength());
+            copyTo(b);
+            b->insert(pos, getPartialKey(k, bucketLevel), leaf);
+            return b;
+        }
+        N *leaves[maxBucketSize + 1];
+        Key keys[maxBucketSize + 1];
+        for (uint32_t i = 0, j = 0; i <= count; ++i) {
+            if (i == pos) {
+                leaves[i] = leaf;
+                keys[i] = k;
+            } else {
+                leaves[i] = getLeaves()[j];
+                loadKey(N::getLeaf(leaves[i]), keys[i]);
+                j++;
+            }
+        }
+        // from the level of the prefix on, the new inner node keeps it
+        return build(leaves, keys, count + 1, level, depth, threadInfo);
+    }
+
+    Bucket *Bucket::shrink(uint32_t pos, uint32_t depth, ThreadInfo &threadInfo) const {
+        auto b = create(capacity / 2, depth, threadInfo);
+        b->setPrefix(getPrefix(), getPrefixLength());
+        memcpy(b->getPartialKeys(), getPartialKeys(), pos * sizeof(uint32_t));
+        memcpy(b->getPartialKeys() + pos, getPartialKeys() + pos + 1, (count - pos - 1) * sizeof(uint32_t));
+        memcpy(b->getLeaves(), getLeaves(), pos * sizeof(ChildRef<N>));
+        memcpy(b->getLeaves() + pos, getLeaves() + pos + 1, (count - pos - 1) * sizeof(ChildRef<N>));
+        b->count = count - 1;
+        return b;
+    }
+
+    uint32_t Bucket::find(uint32_t partialKey, TID tid) const {
+        uint32_t entries = std::min<uint32_t>(count, capacity);
+        for (uint32_t pos = lowerBound(partialKey); pos < entries && getPartialKeys()[pos] == partialKey; ++pos) {
+            if (N::getLeaf(getLeaves()[pos]) == tid) {
+                return pos;
+            }
+        }
+        return entries;
+    }
+
+    void Bucket::remove(uint32_t pos) {
+        memmove(getPartialKeys() + pos, getPartialKeys() + pos + 1, (count - pos - 1) * sizeof(uint32_t));
+        memmove(getLeaves() + pos, getLeaves() + pos + 1, (count - pos - 1) * sizeof(ChildRef<N>));
+        count--;
+    }
+
+    void Bucket::copyTo(Bucket *b) const {
+        assert(count <= b->capacity);
+        memcpy(b->getPartialKeys(), getPartialKeys(), count * sizeof(uint32_t));
+        memcpy(b->getLeaves(), getLeaves(), count * sizeof(ChildRef<N>));
+        b->count = count;
+    }
+
+    N *Bucket::getAnyChild() const {
+        return getLeaves()[0];
+    }
+
+    void Bucket::deleteChildren() {
+        for (uint32_t i = 0; i < count; ++i) {
+            N::deleteNode(getLeaves()[i]);
+        }
+    }
+
+    uint64_t Bucket::getEntries(uint32_t partialKeys[], N *leaves[], uint32_t &entriesCount) const {
+        restart:
+        bool needRestart = false;
+        uint64_t v;
+        v = readLockOrRestart(needRestart);
+        if (needRestart) goto restart;
+        entriesCount = std::min<uint32_t>(count, capacity);
+        for (uint32_t i = 0; i < entriesCount; ++i) {
+            partialKeys[i] = getPartialKeys()[i];
+            leaves[i] = getLeaves()[i];
+        }
+        readUnlockOrRestart(v, needRestart);
+        if (needRestart) goto restart;
+        return v;
+    }
+
+    uint64_t Bucket::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                                 uint32_t &childrenCount) const {
+        restart:
+        bool needRestart = false;
+        uint64_t v;
+        v = readLockOrRestart(needRestart);
+        if (needRestart) goto restart;
+        childrenCount = 0;
+        uint32_t entries = std::min<uint32_t>(count, capacity);
+        for (uint32_t i = lowerBound(static_cast<uint32_t>(start) << 24); i < entries; ++i) {
+            uint8_t key = static_cast<uint8_t>(getPartialKeys()[i] >> 24);
+            if (key > end) {
+                break;
+            }
+            children[childrenCount] = std::make_tuple(key, getLeaves()[i]);
+            childrenCount++;
+        }
+        readUnlockOrRestart(v, needRestart);
+        if (needRestart) goto restart;
+        return v;
+    }
+}
@@ -4,8 +4,11 @@
 #include "N.h"
 #include "N4.cpp"
 #include "N16.cpp"
+#include "N32.cpp"
 #include "N48.cpp"
 #include "N256.cpp"
+#include "Bucket.cpp"
+#include "RootSlot.cpp"
 
 namespace ART_OLC {
 
@@ -14,11 +17,11 @@ namespace ART_OLC {
     }
 
     uint64_t N::convertTypeToVersion(NTypes type) {
-        return (static_cast<uint64_t>(type) << 62);
+        return (static_cast<uint64_t>(type) << 61);
     }
 
     NTypes N::getType() const {
-        return static_cast<NTypes>(typeVersionLockObsolete.load(std::memory_order_relaxed) >> 62);
+        return static_cast<NTypes>(typeVersionLockObsolete.load(std::memory_order_relaxed) >> 61);
     }
 
     void N::writeLockOrRestart(bool &needRestart) {
@@ -31,6 +34,15 @@ namespace ART_OLC {
         if (needRestart) return;
     }
 
+    template<typename Backoff>
+    void N::writeLockOrRestart(bool &needRestart) {
+        uint64_t version;
+        version = readLockOrRestart<Backoff>(needRestart);
+        if (needRestart) return;
+
+        upgradeToWriteLockOrRestart(version, needRestart);
+    }
+
     void N::upgradeToWriteLockOrRestart(uint64_t &version, bool &needRestart) {
         if (typeVersionLockObsolete.compare_exchange_strong(version, version + 0b10)) {
             version = version + 0b10;
@@ -53,6 +65,10 @@ namespace ART_OLC {
                 auto n = static_cast<const N16 *>(node);
                 return n->getAnyChild();
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                return n->getAnyChild();
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 return n->getAnyChild();
@@ -61,6 +77,14 @@ namespace ART_OLC {
                 auto n = static_cast<const N256 *>(node);
                 return n->getAnyChild();
             }
+            case NTypes::Bucket: {
+                auto n = static_cast<const Bucket *>(node);
+                return n->getAnyChild();
+            }
+            case NTypes::RootSlot: {
+                auto n = static_cast<const RootSlot *>(node);
+                return n->getAnyChild();
+            }
         }
         assert(false);
         __builtin_unreachable();
@@ -76,6 +100,10 @@ namespace ART_OLC {
                 auto n = static_cast<N16 *>(node);
                 return n->change(key, val);
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                return n->change(key, val);
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 return n->change(key, val);
@@ -84,13 +112,43 @@ namespace ART_OLC {
                 auto n = static_cast<N256 *>(node);
                 return n->change(key, val);
             }
+            case NTypes::Bucket:
+                // a bucket only holds leaves
+                break;
+            case NTypes::RootSlot: {
+                auto n = static_cast<RootSlot *>(node);
+                return n->change(key, val);
+            }
         }
         assert(false);
         __builtin_unreachable();
     }
 
+    template<typename curN>
+    N *N::createWithChildren(const uint8_t *prefix, uint32_t prefixLength, uint8_t key1, N *child1, uint8_t key2,
+                             N *child2, uint32_t depth, ThreadInfo &threadInfo) {
+        auto n = new(threadInfo.getEpoche().allocateNode(sizeof(curN), depth, threadInfo)) curN(prefix, prefixLength);
+        n->insert(key1, child1);
+        n->insert(key2, child2);
+        return n;
+    }
+
+    N *N::createSized(uint32_t capacity, const uint8_t *prefix, uint32_t prefixLength, uint8_t key1, N *child1,
+                      uint8_t key2, N *child2, uint32_t depth, ThreadInfo &threadInfo) {
+        if (capacity <= 4) {
+            return createWithChildren<N4>(prefix, prefixLength, key1, child1, key2, child2, depth, threadInfo);
+        } else if (capacity <= 16) {
+            return createWithChildren<N16>(prefix, prefixLength, key1, child1, key2, child2, depth, threadInfo);
+        } else if (capacity <= 32) {
+            return createWithChildren<N32>(prefix, prefixLength, key1, child1, key2, child2, depth, threadInfo);
+        } else if (capacity <= 48) {
+            return createWithChildren<N48>(prefix, prefixLength, key1, child1, key2, child2, depth, threadInfo);
+        }
+        return createWithChildren<N256>(prefix, prefixLength, key1, child1, key2, child2, depth, threadInfo);
+    }
+
     template<typename curN, typename biggerN>
-    void N::insertGrow(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, bool &needRestart, ThreadInfo &threadInfo) {
+    void N::insertGrow(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, bool &needRestart, ThreadInfo &threadInfo) {
         if (!n->isFull()) {
             if (parentNode != nullptr) {
                 parentNode->readUnlockOrRestart(parentVersion, needRestart);
@@ -112,37 +170,56 @@ namespace ART_OLC {
             return;
         }
 
-        auto nBig = new biggerN(n->getPrefix(), n->getPrefixLength());
+        auto nBig = new(threadInfo.getEpoche().allocateNode(sizeof(biggerN), depth, threadInfo))
+                biggerN(n->getPrefix(), n->getPrefixLength());
         n->copyTo(nBig);
         nBig->insert(key, val);
 
         N::change(parentNode, keyParent, nBig);
 
         n->writeUnlockObsolete();
-        threadInfo.getEpoche().markNodeForDeletion(n, threadInfo);
+        threadInfo.getEpoche().markNodeForDeletion(n, sizeof(*n), threadInfo);
         parentNode->writeUnlock();
     }
 
-    void N::insertAndUnlock(N *node, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, bool &needRestart, ThreadInfo &threadInfo) {
+    void N::insertAndUnlock(N *node, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, bool &needRestart, ThreadInfo &threadInfo) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
-                insertGrow<N4, N16>(n, v, parentNode, parentVersion, keyParent, key, val, needRestart, threadInfo);
+                insertGrow<N4, N16>(n, v, parentNode, parentVersion, keyParent, key, val, depth, needRestart, threadInfo);
                 break;
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                insertGrow<N16, N48>(n, v, parentNode, parentVersion, keyParent, key, val, needRestart, threadInfo);
+                insertGrow<N16, N32>(n, v, parentNode, parentVersion, keyParent, key, val, depth, needRestart, threadInfo);
+                break;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                insertGrow<N32, N48>(n, v, parentNode, parentVersion, keyParent, key, val, depth, needRestart, threadInfo);
                 break;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                insertGrow<N48, N256>(n, v, parentNode, parentVersion, keyParent, key, val, needRestart, threadInfo);
+                insertGrow<N48, N256>(n, v, parentNode, parentVersion, keyParent, key, val, depth, needRestart, threadInfo);
                 break;
             }
             case NTypes::N256: {
                 auto n = static_cast<N256 *>(node);
-                insertGrow<N256, N256>(n, v, parentNode, parentVersion, keyParent, key, val, needRestart, threadInfo);
+                insertGrow<N256, N256>(n, v, parentNode, parentVersion, keyParent, key, val, depth, needRestart, threadInfo);
+                break;
+            }
+            case NTypes::Bucket:
+                // the tree inserts into buckets by key
+                assert(false);
+                break;
+            case NTypes::RootSlot: {
+                // never full and without parent
+                auto n = static_cast<RootSlot *>(node);
+                n->upgradeToWriteLockOrRestart(v, needRestart);
+                if (needRestart) return;
+                n->insert(key, val);
+                n->writeUnlock();
                 break;
             }
         }
@@ -158,6 +235,10 @@ namespace ART_OLC {
                 auto n = static_cast<const N16 *>(node);
                 return n->getChild(k);
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                return n->getChild(k);
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 return n->getChild(k);
@@ -166,6 +247,13 @@ namespace ART_OLC {
                 auto n = static_cast<const N256 *>(node);
                 return n->getChild(k);
             }
+            case NTypes::Bucket:
+                // the tree searches buckets by key
+                break;
+            case NTypes::RootSlot: {
+                auto n = static_cast<const RootSlot *>(node);
+                return n->getChild(k);
+            }
         }
         assert(false);
         __builtin_unreachable();
@@ -186,6 +274,11 @@ namespace ART_OLC {
                 n->deleteChildren();
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->deleteChildren();
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 n->deleteChildren();
@@ -196,14 +289,24 @@ namespace ART_OLC {
                 n->deleteChildren();
                 return;
             }
+            case NTypes::Bucket: {
+                auto n = static_cast<Bucket *>(node);
+                n->deleteChildren();
+                return;
+            }
+            case NTypes::RootSlot: {
+                auto n = static_cast<RootSlot *>(node);
+                n->deleteChildren();
+                return;
+            }
         }
         assert(false);
         __builtin_unreachable();
     }
 
     template<typename curN, typename smallerN>
-    void N::removeAndShrink(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, bool &needRestart, ThreadInfo &threadInfo) {
-        if (!n->isUnderfull() || parentNode == nullptr) {
+    void N::removeAndShrink(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, uint32_t depth, ShrinkPolicy shrinkPolicy, bool &needRestart, ThreadInfo &threadInfo) {
+        if (!n->isUnderfull(shrinkPolicy) || parentNode == nullptr) {
             if (parentNode != nullptr) {
                 parentNode->readUnlockOrRestart(parentVersion, needRestart);
                 if (needRestart) return;
@@ -224,42 +327,169 @@ namespace ART_OLC {
             return;
         }
 
-        auto nSmall = new smallerN(n->getPrefix(), n->getPrefixLength());
+        auto nSmall = new(threadInfo.getEpoche().allocateNode(sizeof(smallerN), depth, threadInfo))
+                smallerN(n->getPrefix(), n->getPrefixLength());
 
         n->copyTo(nSmall);
         nSmall->remove(key);
         N::change(parentNode, keyParent, nSmall);
 
         n->writeUnlockObsolete();
-        threadInfo.getEpoche().markNodeForDeletion(n, threadInfo);
+        threadInfo.getEpoche().markNodeForDeletion(n, sizeof(*n), threadInfo);
         parentNode->writeUnlock();
     }
 
-    void N::removeAndUnlock(N *node, uint64_t v, uint8_t key, N *parentNode, uint64_t parentVersion, uint8_t keyParent, bool &needRestart, ThreadInfo &threadInfo) {
+    void N::removeAndUnlock(N *node, uint64_t v, uint8_t key, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint32_t depth, ShrinkPolicy shrinkPolicy, bool &needRestart, ThreadInfo &threadInfo) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
-                removeAndShrink<N4, N4>(n, v, parentNode, parentVersion, keyParent, key, needRestart, threadInfo);
+                removeAndShrink<N4, N4>(n, v, parentNode, parentVersion, keyParent, key, depth, shrinkPolicy, needRestart, threadInfo);
                 break;
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                removeAndShrink<N16, N4>(n, v, parentNode, parentVersion, keyParent, key, needRestart, threadInfo);
+                removeAndShrink<N16, N4>(n, v, parentNode, parentVersion, keyParent, key, depth, shrinkPolicy, needRestart, threadInfo);
+                break;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                removeAndShrink<N32, N16>(n, v, parentNode, parentVersion, keyParent, key, depth, shrinkPolicy, needRestart, threadInfo);
                 break;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                removeAndShrink<N48, N16>(n, v, parentNode, parentVersion, keyParent, key, needRestart, threadInfo);
+                removeAndShrink<N48, N32>(n, v, parentNode, parentVersion, keyParent, key, depth, shrinkPolicy, needRestart, threadInfo);
                 break;
             }
             case NTypes::N256: {
                 auto n = static_cast<N256 *>(node);
-                removeAndShrink<N256, N48>(n, v, parentNode, parentVersion, keyParent, key, needRestart, threadInfo);
+                removeAndShrink<N256, N48>(n, v, parentNode, parentVersion, keyParent, key, depth, shrinkPolicy, needRestart, threadInfo);
+                break;
+            }
+            case NTypes::Bucket:
+                // the tree removes from buckets by key
+                assert(false);
+                break;
+            case NTypes::RootSlot: {
+                // never underfull and without parent
+                auto n = static_cast<RootSlot *>(node);
+                n->upgradeToWriteLockOrRestart(v, needRestart);
+                if (needRestart) return;
+                n->remove(key);
+                n->writeUnlock();
                 break;
             }
         }
     }
 
+    NTypes N::getCompactType(const N *node) {
+        uint32_t count = node->getCount();
+        switch (node->getType()) {
+            case NTypes::N256:
+                // the count of a full N256 wraps around
+                if (count == 0 || count > 36) {
+                    return NTypes::N256;
+                }
+                // fallthrough
+            case NTypes::N48:
+                if (count > 23) {
+                    return NTypes::N48;
+                }
+                // fallthrough
+            case NTypes::N32:
+                if (count > 11) {
+                    return NTypes::N32;
+                }
+                // fallthrough
+            case NTypes::N16:
+                if (count > 2) {
+                    return NTypes::N16;
+                }
+                return NTypes::N4;
+            default:
+                return node->getType();
+        }
+    }
+
+    template<typename curN>
+    N *N::copyToSmaller(const curN *n, NTypes type, uint32_t depth, ThreadInfo &threadInfo) {
+        auto &epoche = threadInfo.getEpoche();
+        switch (type) {
+            case NTypes::N4: {
+                auto nSmall = new(epoche.allocateNode(sizeof(N4), depth, threadInfo)) N4(n->getPrefix(), n->getPrefixLength());
+                n->copyTo(nSmall);
+                return nSmall;
+            }
+            case NTypes::N16: {
+                auto nSmall = new(epoche.allocateNode(sizeof(N16), depth, threadInfo)) N16(n->getPrefix(), n->getPrefixLength());
+                n->copyTo(nSmall);
+                return nSmall;
+            }
+            case NTypes::N32: {
+                auto nSmall = new(epoche.allocateNode(sizeof(N32), depth, threadInfo)) N32(n->getPrefix(), n->getPrefixLength());
+                n->copyTo(nSmall);
+                return nSmall;
+            }
+            case NTypes::N48: {
+                auto nSmall = new(epoche.allocateNode(sizeof(N48), depth, threadInfo)) N48(n->getPrefix(), n->getPrefixLength());
+                n->copyTo(nSmall);
+                return nSmall;
+            }
+            default:
+                assert(false);
+                __builtin_unreachable();
+        }
+    }
+
+    N *N::copyToSmaller(const N *node, NTypes type, uint32_t depth, ThreadInfo &threadInfo) {
+        switch (node->getType()) {
+            case NTypes::N16:
+                return copyToSmaller(static_cast<const N16 *>(node), type, depth, threadInfo);
+            case NTypes::N32:
+                return copyToSmaller(static_cast<const N32 *>(node), type, depth, threadInfo);
+            case NTypes::N48:
+                return copyToSmaller(static_cast<const N48 *>(node), type, depth, threadInfo);
+            case NTypes::N256:
+                return copyToSmaller(static_cast<const N256 *>(node), type, depth, threadInfo);
+            default:
+                assert(false);
+                __builtin_unreachable();
+        }
+    }
+
+    void N::getChildrenOptimistic(const N *node, std::tuple<uint8_t, N *> children[], uint32_t &childrenCount) {
+        // takes the children like a node they are copied to
+        struct Collector {
+            std::tuple<uint8_t, N *> *children;
+            uint32_t &childrenCount;
+
+            void insert(uint8_t key, N *child) {
+                children[childrenCount++] = std::make_tuple(key, child);
+            }
+        } collector{children, childrenCount};
+        childrenCount = 0;
+        switch (node->getType()) {
+            case NTypes::N4:
+                static_cast<const N4 *>(node)->copyTo(&collector);
+                break;
+            case NTypes::N16:
+                static_cast<const N16 *>(node)->copyTo(&collector);
+                break;
+            case NTypes::N32:
+                static_cast<const N32 *>(node)->copyTo(&collector);
+                break;
+            case NTypes::N48:
+                static_cast<const N48 *>(node)->copyTo(&collector);
+                break;
+            case NTypes::N256:
+                static_cast<const N256 *>(node)->copyTo(&collector);
+                break;
+            default:
+                assert(false);
+                break;
+        }
+    }
+
     bool N::isLocked(uint64_t version) const {
         return ((version & 0b10) == 0b10);
     }
@@ -279,6 +509,22 @@ namespace ART_OLC {
         //return version;
     }
 
+    template<typename Backoff>
+    uint64_t N::readLockOrRestart(bool &needRestart) const {
+        uint64_t version;
+        version = typeVersionLockObsolete.load();
+        if (Backoff::waitsForLocks) {
+            for (uint32_t attempt = 1; isLocked(version); ++attempt) {
+                Backoff::spin(attempt);
+                version = typeVersionLockObsolete.load();
+            }
+        }
+        if (isLocked(version) || isObsolete(version)) {
+            needRestart = true;
+        }
+        return version;
+    }
+
     bool N::isObsolete(uint64_t version) {
         return (version & 1) == 1;
     }
@@ -332,20 +578,95 @@ namespace ART_OLC {
         return (reinterpret_cast<uint64_t>(n) & (static_cast<uint64_t>(1) << 63)) == (static_cast<uint64_t>(1) << 63);
     }
 
-    N *N::setLeaf(TID tid) {
-        return reinterpret_cast<N *>(tid | (static_cast<uint64_t>(1) << 63));
+    N *N::setLeaf(TID tid, const Key &k, ThreadInfo &threadInfo) {
+        uint64_t value = tid;
+#ifdef ART_LEAF_FINGERPRINTS
+        assert(tid < (static_cast<uint64_t>(1) << fingerprintShift));
+        value |= static_cast<uint64_t>(k.getFingerprint()) << fingerprintShift;
+#else
+        (void) k;
+#endif
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isInline(tid)) {
+            // no room for the fingerprint
+            return reinterpret_cast<N *>(tid | (static_cast<uint64_t>(1) << 63));
+        }
+        // never interleaved, the cell is only read with the leaf
+        auto cell = static_cast<uint64_t *>(threadInfo.getEpoche().allocateNode(
+                sizeof(TID), std::numeric_limits<uint32_t>::max(), threadInfo));
+        *cell = value;
+        return ChildRef<N>::setCell(cell);
+#else
+        (void) threadInfo;
+        return reinterpret_cast<N *>(value | (static_cast<uint64_t>(1) << 63));
+#endif
+    }
+
+    void N::retireLeaf(N *leaf, ThreadInfo &threadInfo) {
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isCell(leaf)) {
+            threadInfo.getEpoche().markNodeForDeletion(ChildRef<N>::getCell(leaf), sizeof(TID), threadInfo);
+        }
+#else
+        (void) leaf;
+        (void) threadInfo;
+#endif
     }
 
     TID N::getLeaf(const N *n) {
-        return (reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << 63) - 1));
+        uint64_t value = reinterpret_cast<uint64_t>(n);
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isCell(n)) {
+            value = *ChildRef<N>::getCell(n);
+        }
+#endif
+#ifdef ART_LEAF_FINGERPRINTS
+        return value & ((static_cast<uint64_t>(1) << fingerprintShift) - 1);
+#else
+        return value & ((static_cast<uint64_t>(1) << 63) - 1);
+#endif
+    }
+
+    bool N::matchesFingerprint(const N *leaf, const Key &k) {
+#ifdef ART_LEAF_FINGERPRINTS
+        uint64_t value = reinterpret_cast<uint64_t>(leaf);
+#ifdef ART_COMPRESSED_POINTERS
+        if (ChildRef<N>::isCell(leaf)) {
+            value = *ChildRef<N>::getCell(leaf);
+        }
+#endif
+        uint8_t fingerprint = static_cast<uint8_t>(value >> fingerprintShift);
+        // leaves without a fingerprint have to be checked
+        return fingerprint == 0 || fingerprint == k.getFingerprint();
+#else
+        (void) leaf;
+        (void) k;
+        return true;
+#endif
     }
-
     std::tuple<N *, uint8_t> N::getSecondChild(N *node, const uint8_t key) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
                 return n->getSecondChild(key);
             }
+            // node types of two children as well, created with room to grow
+            case NTypes::N16: {
+                auto n = static_cast<N16 *>(node);
+                return n->getSecondChild(key);
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                return n->getSecondChild(key);
+            }
+            case NTypes::N48: {
+                auto n = static_cast<N48 *>(node);
+                return n->getSecondChild(key);
+            }
+            case NTypes::N256: {
+                auto n = static_cast<N256 *>(node);
+                return n->getSecondChild(key);
+            }
             default: {
                 assert(false);
                 __builtin_unreachable();
@@ -353,33 +674,79 @@ namespace ART_OLC {
         }
     }
 
+    std::size_t N::getNodeSize(const N *node) {
+        switch (node->getType()) {
+            case NTypes::N4:
+                return sizeof(N4);
+            case NTypes::N16:
+                return sizeof(N16);
+            case NTypes::N32:
+                return sizeof(N32);
+            case NTypes::N48:
+                return sizeof(N48);
+            case NTypes::N256:
+                return sizeof(N256);
+            case NTypes::Bucket:
+                return Bucket::getSize(static_cast<const Bucket *>(node)->getCapacity());
+            case NTypes::RootSlot:
+                return sizeof(RootSlot);
+        }
+        return sizeof(N);
+    }
+
     void N::deleteNode(N *node) {
         if (N::isLeaf(node)) {
+#ifdef ART_COMPRESSED_POINTERS
+            if (ChildRef<N>::isCell(node)) {
+                freeNodeMemory(ChildRef<N>::getCell(node), sizeof(TID));
+            }
+#endif
             return;
         }
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
-                delete n;
+                n->~N4();
+                freeNodeMemory(n, sizeof(N4));
                 return;
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                delete n;
+                n->~N16();
+                freeNodeMemory(n, sizeof(N16));
+                return;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->~N32();
+                freeNodeMemory(n, sizeof(N32));
                 return;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                delete n;
+                n->~N48();
+                freeNodeMemory(n, sizeof(N48));
                 return;
             }
             case NTypes::N256: {
                 auto n = static_cast<N256 *>(node);
-                delete n;
+                n->~N256();
+                freeNodeMemory(n, sizeof(N256));
+                return;
+            }
+            case NTypes::Bucket: {
+                auto n = static_cast<Bucket *>(node);
+                std::size_t size = getNodeSize(n);
+                n->~Bucket();
+                freeNodeMemory(n, size);
                 return;
             }
+            case NTypes::RootSlot:
+                // freed with the whole root table
+                break;
         }
-        delete node;
+        assert(false);
+        __builtin_unreachable();
     }
 
 
@@ -413,6 +780,10 @@ namespace ART_OLC {
                 auto n = static_cast<const N16 *>(node);
                 return n->getChildren(start, end, children, childrenCount);
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                return n->getChildren(start, end, children, childrenCount);
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 return n->getChildren(start, end, children, childrenCount);
@@ -421,6 +792,14 @@ namespace ART_OLC {
                 auto n = static_cast<const N256 *>(node);
                 return n->getChildren(start, end, children, childrenCount);
             }
+            case NTypes::Bucket: {
+                auto n = static_cast<const Bucket *>(node);
+                return n->getChildren(start, end, children, childrenCount);
+            }
+            case NTypes::RootSlot: {
+                auto n = static_cast<const RootSlot *>(node);
+                return n->getChildren(start, end, children, childrenCount);
+            }
         }
         assert(false);
         __builtin_unreachable();
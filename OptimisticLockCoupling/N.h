@@ -11,6 +11,8 @@
 #include <string.h>
 #include "../Key.h"
 #include "../Epoche.h"
+#include "../NodeSearch.h"
+#include "Backoff.h"
 
 using TID = uint64_t;
 
@@ -26,12 +28,38 @@ namespace ART_OLC {
     enum class NTypes : uint8_t {
         N4 = 0,
         N16 = 1,
-        N48 = 2,
-        N256 = 3
+        N32 = 2,
+        N48 = 3,
+        N256 = 4,
+        // 5 is the N65536 of the unsynchronized tree
+        Bucket = 6,
+        RootSlot = 7
+    };
+
+    /**
+     * When a remove replaces a node by the next smaller type. A workload that inserts and removes around a
+     * threshold allocates, copies and retires a node and write-locks its parent on every flip.
+     */
+    enum class ShrinkPolicy : uint8_t {
+        // as soon as the children fit into the smaller type with some room left, the thresholds of the ART paper
+        Eager,
+        // only once the children fill at most half of the smaller type, the node grows again after twice as many
+        // inserts
+        Hysteresis,
+        // never on remove, compact() of the tree shrinks the nodes later
+        Lazy
     };
 
     static constexpr uint32_t maxStoredPrefixLength = 11;
 
+    // the most leaves a Bucket holds before it splits
+    static constexpr uint32_t maxBucketSize = 16;
+
+#ifdef ART_LEAF_FINGERPRINTS
+    // the 8 bits below the leaf bit hold the fingerprint of the key, TIDs have to fit into the bits below
+    static constexpr uint32_t fingerprintShift = 55;
+#endif
+
     using Prefix = uint8_t[maxStoredPrefixLength];
 
     class N {
@@ -45,7 +73,7 @@ namespace ART_OLC {
 
         N(N &&) = delete;
 
-        //2b type 60b version 1b lock 1b obsolete
+        //3b type 59b version 1b lock 1b obsolete
         std::atomic<uint64_t> typeVersionLockObsolete{0b100};
         // version 1, unlocked, not obsolete
         uint32_t prefixCount = 0;
@@ -68,12 +96,22 @@ namespace ART_OLC {
 
         void writeLockOrRestart(bool &needRestart);
 
+        template<typename Backoff>
+        void writeLockOrRestart(bool &needRestart);
+
         void upgradeToWriteLockOrRestart(uint64_t &version, bool &needRestart);
 
         void writeUnlock();
 
         uint64_t readLockOrRestart(bool &needRestart) const;
 
+        /**
+         * waits with the given backoff policy while the node is locked instead of restarting right away,
+         * still restarts if the node is obsolete
+         */
+        template<typename Backoff>
+        uint64_t readLockOrRestart(bool &needRestart) const;
+
         /**
          * returns true if node hasn't been changed in between
          */
@@ -91,12 +129,12 @@ namespace ART_OLC {
 
         static N *getChild(const uint8_t k, const N *node);
 
-        static void insertAndUnlock(N *node, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, bool &needRestart,
+        static void insertAndUnlock(N *node, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, bool &needRestart,
                                     ThreadInfo &threadInfo);
 
         static bool change(N *node, uint8_t key, N *val);
 
-        static void removeAndUnlock(N *node, uint64_t v, uint8_t key, N *parentNode, uint64_t parentVersion, uint8_t keyParent, bool &needRestart, ThreadInfo &threadInfo);
+        static void removeAndUnlock(N *node, uint64_t v, uint8_t key, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint32_t depth, ShrinkPolicy shrinkPolicy, bool &needRestart, ThreadInfo &threadInfo);
 
         bool hasPrefix() const;
 
@@ -112,7 +150,22 @@ namespace ART_OLC {
 
         static bool isLeaf(const N *n);
 
-        static N *setLeaf(TID tid);
+        /**
+         * with compressed pointers a TID that does not fit into a child reference is stored in a cell
+         * allocated from the epoche
+         */
+        static N *setLeaf(TID tid, const Key &k, ThreadInfo &threadInfo);
+
+        /**
+         * false if the fingerprint stored with the leaf rules out that it belongs to k, always true without
+         * ART_LEAF_FINGERPRINTS
+         */
+        static bool matchesFingerprint(const N *leaf, const Key &k);
+
+        /**
+         * marks the cell of a leaf that has been removed from the tree for deletion
+         */
+        static void retireLeaf(N *leaf, ThreadInfo &threadInfo);
 
         static N *getAnyChild(const N *n);
 
@@ -122,13 +175,46 @@ namespace ART_OLC {
 
         static void deleteNode(N *node);
 
+        static std::size_t getNodeSize(const N *node);
+
         static std::tuple<N *, uint8_t> getSecondChild(N *node, const uint8_t k);
 
+        /**
+         * a new inner node of the smallest type with room for capacity children that holds the two children given,
+         * for a node that is expected to fill up so that it skips the grow steps on the way
+         */
+        static N *createSized(uint32_t capacity, const uint8_t *prefix, uint32_t prefixLength, uint8_t key1, N *child1,
+                              uint8_t key2, N *child2, uint32_t depth, ThreadInfo &threadInfo);
+
+        template<typename curN>
+        static N *createWithChildren(const uint8_t *prefix, uint32_t prefixLength, uint8_t key1, N *child1,
+                                     uint8_t key2, N *child2, uint32_t depth, ThreadInfo &threadInfo);
+
         template<typename curN, typename biggerN>
-        static void insertGrow(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, bool &needRestart, ThreadInfo &threadInfo);
+        static void insertGrow(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, bool &needRestart, ThreadInfo &threadInfo);
 
         template<typename curN, typename smallerN>
-        static void removeAndShrink(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, bool &needRestart, ThreadInfo &threadInfo);
+        static void removeAndShrink(curN *n, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t keyParent, uint8_t key, uint32_t depth, ShrinkPolicy shrinkPolicy, bool &needRestart, ThreadInfo &threadInfo);
+
+        /**
+         * the smallest type that holds the children of an inner node with the room eager shrinking leaves, the
+         * type of the node itself if it is not bigger
+         */
+        static NTypes getCompactType(const N *node);
+
+        /**
+         * a copy of a locked inner node as the smaller type given
+         */
+        static N *copyToSmaller(const N *node, NTypes type, uint32_t depth, ThreadInfo &threadInfo);
+
+        template<typename curN>
+        static N *copyToSmaller(const curN *n, NTypes type, uint32_t depth, ThreadInfo &threadInfo);
+
+        /**
+         * the children of an inner node read without waiting for its lock, only valid if the version of the node
+         * did not change meanwhile
+         */
+        static void getChildrenOptimistic(const N *node, std::tuple<uint8_t, N *> children[], uint32_t &childrenCount);
 
         static uint64_t getChildren(const N *node, uint8_t start, uint8_t end, std::tuple<uint8_t, N *> children[],
                                 uint32_t &childrenCount);
@@ -137,7 +223,7 @@ namespace ART_OLC {
     class N4 : public N {
     public:
         uint8_t keys[4];
-        N *children[4] = {nullptr, nullptr, nullptr, nullptr};
+        ChildRef<N> children[4] = {nullptr, nullptr, nullptr, nullptr};
 
     public:
         N4(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N4, prefix,
@@ -158,7 +244,7 @@ namespace ART_OLC {
 
         bool isFull() const;
 
-        bool isUnderfull() const;
+        bool isUnderfull(ShrinkPolicy shrinkPolicy) const;
 
         std::tuple<N *, uint8_t> getSecondChild(const uint8_t key) const;
 
@@ -171,7 +257,7 @@ namespace ART_OLC {
     class N16 : public N {
     public:
         uint8_t keys[16];
-        N *children[16];
+        ChildRef<N> children[16];
 
         static uint8_t flipSign(uint8_t keyByte) {
             // Flip the sign bit, enables signed SSE comparison of unsigned values, used by Node16
@@ -192,7 +278,7 @@ namespace ART_OLC {
 #endif
         }
 
-        N *const *getChildPos(const uint8_t k) const;
+        const ChildRef<N> *getChildPos(const uint8_t k) const;
 
     public:
         N16(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N16, prefix,
@@ -216,7 +302,57 @@ namespace ART_OLC {
 
         bool isFull() const;
 
-        bool isUnderfull() const;
+        bool isUnderfull(ShrinkPolicy shrinkPolicy) const;
+
+        std::tuple<N *, uint8_t> getSecondChild(const uint8_t key) const;
+
+        void deleteChildren();
+
+        uint64_t getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                         uint32_t &childrenCount) const;
+    };
+
+    class N32 : public N {
+    public:
+        uint8_t keys[32];
+        ChildRef<N> children[32];
+
+        static uint8_t flipSign(uint8_t keyByte) {
+            return keyByte ^ 128;
+        }
+
+        // the first count keys
+        uint32_t usedMask() const {
+            return static_cast<uint32_t>((static_cast<uint64_t>(1) << count) - 1);
+        }
+
+        const ChildRef<N> *getChildPos(const uint8_t k) const;
+
+    public:
+        N32(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N32, prefix,
+                                                                              prefixLength) {
+            memset(keys, 0, sizeof(keys));
+            memset(children, 0, sizeof(children));
+        }
+
+        void insert(uint8_t key, N *n);
+
+        template<class NODE>
+        void copyTo(NODE *n) const;
+
+        bool change(uint8_t key, N *val);
+
+        N *getChild(const uint8_t k) const;
+
+        void remove(uint8_t k);
+
+        N *getAnyChild() const;
+
+        bool isFull() const;
+
+        bool isUnderfull(ShrinkPolicy shrinkPolicy) const;
+
+        std::tuple<N *, uint8_t> getSecondChild(const uint8_t key) const;
 
         void deleteChildren();
 
@@ -226,7 +362,7 @@ namespace ART_OLC {
 
     class N48 : public N {
         uint8_t childIndex[256];
-        N *children[48];
+        ChildRef<N> children[48];
     public:
         static const uint8_t emptyMarker = 48;
 
@@ -251,7 +387,9 @@ namespace ART_OLC {
 
         bool isFull() const;
 
-        bool isUnderfull() const;
+        bool isUnderfull(ShrinkPolicy shrinkPolicy) const;
+
+        std::tuple<N *, uint8_t> getSecondChild(const uint8_t key) const;
 
         void deleteChildren();
 
@@ -260,12 +398,15 @@ namespace ART_OLC {
     };
 
     class N256 : public N {
-        N *children[256];
+        ChildRef<N> children[256];
+        // bit i set if children[i] is not null
+        uint64_t bitmap[4];
 
     public:
         N256(const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N256, prefix,
                                                                                prefixLength) {
             memset(children, '\0', sizeof(children));
+            memset(bitmap, 0, sizeof(bitmap));
         }
 
         void insert(uint8_t key, N *val);
@@ -283,12 +424,143 @@ namespace ART_OLC {
 
         bool isFull() const;
 
-        bool isUnderfull() const;
+        bool isUnderfull(ShrinkPolicy shrinkPolicy) const;
+
+        std::tuple<N *, uint8_t> getSecondChild(const uint8_t key) const;
 
         void deleteChildren();
 
         uint64_t getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                          uint32_t &childrenCount) const;
     };
+
+    /**
+     * One entry of the direct-addressed root table, an inner node without prefix for one value of the first one or
+     * two key bytes with at most one child. Slots are never replaced, so they have no parent and growing or
+     * splitting a child at the top only locks the slot of its own key bytes.
+     */
+    class RootSlot : public N {
+        ChildRef<N> child = nullptr;
+        // the last key byte of the slot
+        uint8_t key = 0;
+
+    public:
+        RootSlot() : N(NTypes::RootSlot, nullptr, 0) { }
+
+        void setKey(uint8_t key);
+
+        void insert(uint8_t key, N *n);
+
+        bool change(uint8_t key, N *val);
+
+        N *getChild(const uint8_t k) const;
+
+        void remove(uint8_t k);
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        uint64_t getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                             uint32_t &childrenCount) const;
+    };
+
+    /**
+     * Up to maxBucketSize leaves in key order in place of the small inner nodes at the bottom of the tree, the
+     * insert creates buckets instead of an N4 for two leaves with ART_LEAF_BUCKETS. Each entry keeps the four key
+     * bytes behind the prefix of the bucket, big-endian and padded with 0, a lookup binary searches them and only
+     * loads keys they do not cover. Readers validate against the version lock of the bucket like for any node. A
+     * full bucket is replaced by one of twice the capacity, at maxBucketSize by inner nodes over smaller buckets.
+     * A bucket starts without prefix and gets one if its parent is merged into it.
+     */
+    class Bucket : public N {
+        uint8_t capacity;
+
+        explicit Bucket(uint32_t capacity) : N(NTypes::Bucket, nullptr, 0), capacity(capacity) { }
+
+        template<typename curN>
+        static N *buildInner(N *const leaves[], const Key keys[], uint32_t count, uint32_t level,
+                             uint32_t prefixLength, uint32_t depth, ThreadInfo &threadInfo);
+
+    public:
+        static std::size_t getSize(uint32_t capacity);
+
+        static Bucket *create(uint32_t capacity, uint32_t depth, ThreadInfo &threadInfo);
+
+        /**
+         * the four key bytes from level on as one big-endian number, 0 behind the end of the key
+         */
+        static uint32_t getPartialKey(const Key &k, uint32_t level);
+
+        /**
+         * the subtree of count sorted leaves and their keys that all continue in the same child at level: the leaf,
+         * a bucket or inner nodes with buckets below, its root at depth
+         */
+        static N *build(N *const leaves[], const Key keys[], uint32_t count, uint32_t level, uint32_t depth,
+                        ThreadInfo &threadInfo);
+
+        uint32_t getCapacity() const;
+
+        bool isFull() const;
+
+        bool isUnderfull() const;
+
+        // capacity partial keys followed by capacity leaves
+        uint32_t *getPartialKeys();
+
+        const uint32_t *getPartialKeys() const;
+
+        ChildRef<N> *getLeaves();
+
+        const ChildRef<N> *getLeaves() const;
+
+        /**
+         * the first entry whose partial key is not smaller than partialKey
+         */
+        uint32_t lowerBound(uint32_t partialKey) const;
+
+        /**
+         * the entry k is inserted before, loads the keys of the entries with the same partial key
+         */
+        uint32_t getInsertPosition(const Key &k, uint32_t level, void (*loadKey)(TID, Key &)) const;
+
+        void insert(uint32_t pos, uint32_t partialKey, N *leaf);
+
+        /**
+         * the bucket or subtree that replaces this full bucket with the leaf of k inserted at pos, level is the level
+         * of the first prefix byte of the bucket
+         */
+        N *grow(uint32_t pos, N *leaf, const Key &k, uint32_t level, void (*loadKey)(TID, Key &), uint32_t depth,
+                ThreadInfo &threadInfo) const;
+
+        /**
+         * the bucket of half the capacity that replaces this underfull one without the entry at pos
+         */
+        Bucket *shrink(uint32_t pos, uint32_t depth, ThreadInfo &threadInfo) const;
+
+        /**
+         * the entry with the partial key that holds tid, getCount() if there is none
+         */
+        uint32_t find(uint32_t partialKey, TID tid) const;
+
+        void remove(uint32_t pos);
+
+        void copyTo(Bucket *b) const;
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        /**
+         * a consistent copy of the entries, returns the version it was read at
+         */
+        uint64_t getEntries(uint32_t partialKeys[], N *leaves[], uint32_t &entriesCount) const;
+
+        /**
+         * the leaves whose first partial key byte is between start and end, with that byte as key
+         */
+        uint64_t getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                             uint32_t &childrenCount) const;
+    };
 }
 #endif //ART_OPTIMISTIC_LOCK_COUPLING_N_H
@@ -1,7 +1,6 @@
 #include <assert.h>
 #include <algorithm>
 #include "N.h"
-#include <emmintrin.h> // x86 SSE intrinsics
 
 namespace ART_OLC {
 
@@ -9,17 +8,17 @@ namespace ART_OLC {
         return count == 16;
     }
 
-    bool N16::isUnderfull() const {
-        return count == 3;
+    bool N16::isUnderfull(ShrinkPolicy shrinkPolicy) const {
+        // the two children left fill half of an N4 already
+        return shrinkPolicy != ShrinkPolicy::Lazy && count == 3;
     }
 
     void N16::insert(uint8_t key, N *n) {
         uint8_t keyByteFlipped = flipSign(key);
-        __m128i cmp = _mm_cmplt_epi8(_mm_set1_epi8(keyByteFlipped), _mm_loadu_si128(reinterpret_cast<__m128i *>(keys)));
-        uint16_t bitfield = _mm_movemask_epi8(cmp) & (0xFFFF >> (16 - count));
+        uint16_t bitfield = NodeSearch::greaterMask16(keys, keyByteFlipped) & (0xFFFF >> (16 - count));
         unsigned pos = bitfield ? ctz(bitfield) : count;
         memmove(keys + pos + 1, keys + pos, count - pos);
-        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(uintptr_t));
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(children[0]));
         keys[pos] = keyByteFlipped;
         children[pos] = n;
         count++;
@@ -33,16 +32,14 @@ namespace ART_OLC {
     }
 
     bool N16::change(uint8_t key, N *val) {
-        N **childPos = const_cast<N **>(getChildPos(key));
+        ChildRef<N> *childPos = const_cast<ChildRef<N> *>(getChildPos(key));
         assert(childPos != nullptr);
         *childPos = val;
         return true;
     }
 
-    N *const *N16::getChildPos(const uint8_t k) const {
-        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(flipSign(k)),
-                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
-        unsigned bitfield = _mm_movemask_epi8(cmp) & ((1 << count) - 1);
+    const ChildRef<N> *N16::getChildPos(const uint8_t k) const {
+        unsigned bitfield = NodeSearch::equalMask16(keys, flipSign(k)) & ((1 << count) - 1);
         if (bitfield) {
             return &children[ctz(bitfield)];
         } else {
@@ -51,7 +48,7 @@ namespace ART_OLC {
     }
 
     N *N16::getChild(const uint8_t k) const {
-        N *const *childPos = getChildPos(k);
+        const ChildRef<N> *childPos = getChildPos(k);
         if (childPos == nullptr) {
             return nullptr;
         } else {
@@ -60,11 +57,11 @@ namespace ART_OLC {
     }
 
     void N16::remove(uint8_t k) {
-        N *const *leafPlace = getChildPos(k);
+        const ChildRef<N> *leafPlace = getChildPos(k);
         assert(leafPlace != nullptr);
         std::size_t pos = leafPlace - children;
         memmove(keys + pos, keys + pos + 1, count - pos - 1);
-        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(N *));
+        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(children[0]));
         count--;
         assert(getChild(k) == nullptr);
     }
@@ -78,6 +75,16 @@ namespace ART_OLC {
         return children[0];
     }
 
+    std::tuple<N *, uint8_t> N16::getSecondChild(const uint8_t key) const {
+        uint8_t keyByteFlipped = flipSign(key);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (keys[i] != keyByteFlipped) {
+                return std::make_tuple(children[i], flipSign(keys[i]));
+            }
+        }
+        return std::make_tuple(nullptr, 0);
+    }
+
     void N16::deleteChildren() {
         for (std::size_t i = 0; i < count; ++i) {
             N::deleteChildren(children[i]);
@@ -93,16 +100,11 @@ namespace ART_OLC {
         v = readLockOrRestart(needRestart);
         if (needRestart) goto restart;
         childrenCount = 0;
-        auto startPos = getChildPos(start);
-        auto endPos = getChildPos(end);
-        if (startPos == nullptr) {
-            startPos = this->children;
-        }
-        if (endPos == nullptr) {
-            endPos = this->children + (count - 1);
-        }
-        for (auto p = startPos; p <= endPos; ++p) {
-            children[childrenCount] = std::make_tuple(flipSign(keys[p - this->children]), *p);
+        // the keys are sorted, the ones in the range are consecutive
+        unsigned bitfield = NodeSearch::rangeMask16(keys, flipSign(start), flipSign(end)) & ((1 << count) - 1);
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = ctz(bitfield);
+            children[childrenCount] = std::make_tuple(flipSign(keys[pos]), this->children[pos]);
             childrenCount++;
         }
         readUnlockOrRestart(v, needRestart);
@@ -8,31 +8,38 @@ namespace ART_OLC {
         return false;
     }
 
-    bool N256::isUnderfull() const {
-        return count == 37;
+    bool N256::isUnderfull(ShrinkPolicy shrinkPolicy) const {
+        switch (shrinkPolicy) {
+            case ShrinkPolicy::Eager:
+                return count == 37;
+            case ShrinkPolicy::Hysteresis:
+                return count == 25;
+            case ShrinkPolicy::Lazy:
+                break;
+        }
+        return false;
     }
 
     void N256::deleteChildren() {
-        for (uint64_t i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                N::deleteChildren(children[i]);
-                N::deleteNode(children[i]);
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this](unsigned i) {
+            N::deleteChildren(children[i]);
+            N::deleteNode(children[i]);
+            return true;
+        });
     }
 
     void N256::insert(uint8_t key, N *val) {
         children[key] = val;
+        bitmap[key / 64] |= static_cast<uint64_t>(1) << (key % 64);
         count++;
     }
 
     template<class NODE>
     void N256::copyTo(NODE *n) const {
-        for (int i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                n->insert(i, children[i]);
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, n](unsigned i) {
+            n->insert(i, children[i]);
+            return true;
+        });
     }
 
     bool N256::change(uint8_t key, N *n) {
@@ -46,23 +53,31 @@ namespace ART_OLC {
 
     void N256::remove(uint8_t k) {
         children[k] = nullptr;
+        bitmap[k / 64] &= ~(static_cast<uint64_t>(1) << (k % 64));
         count--;
     }
 
     N *N256::getAnyChild() const {
         N *anyChild = nullptr;
-        for (uint64_t i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                if (N::isLeaf(children[i])) {
-                    return children[i];
-                } else {
-                    anyChild = children[i];
-                }
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, &anyChild](unsigned i) {
+            anyChild = children[i];
+            return !N::isLeaf(anyChild);
+        });
         return anyChild;
     }
 
+    std::tuple<N *, uint8_t> N256::getSecondChild(const uint8_t key) const {
+        std::tuple<N *, uint8_t> second(nullptr, 0);
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, key, &second](unsigned i) {
+            if (i == key) {
+                return true;
+            }
+            second = std::make_tuple(children[i], i);
+            return false;
+        });
+        return second;
+    }
+
     uint64_t N256::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                            uint32_t &childrenCount) const {
         restart:
@@ -71,12 +86,11 @@ namespace ART_OLC {
         v = readLockOrRestart(needRestart);
         if (needRestart) goto restart;
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
-            if (this->children[i] != nullptr) {
-                children[childrenCount] = std::make_tuple(i, this->children[i]);
-                childrenCount++;
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, start, end, [this, children, &childrenCount](unsigned i) {
+            children[childrenCount] = std::make_tuple(i, this->children[i]);
+            childrenCount++;
+            return true;
+        });
         readUnlockOrRestart(v, needRestart);
         if (needRestart) goto restart;
         return v;
@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_OLC {
+
+    bool N32::isFull() const {
+        return count == 32;
+    }
+
+    bool N32::isUnderfull(ShrinkPolicy shrinkPolicy) const {
+        switch (shrinkPolicy) {
+            case ShrinkPolicy::Eager:
+                return count == 12;
+            case ShrinkPolicy::Hysteresis:
+                return count == 9;
+            case ShrinkPolicy::Lazy:
+                break;
+        }
+        return false;
+    }
+
+    void N32::insert(uint8_t key, N *n) {
+        uint8_t keyByteFlipped = flipSign(key);
+        uint32_t bitfield = NodeSearch::greaterMask32(keys, keyByteFlipped) & usedMask();
+        unsigned pos = bitfield ? __builtin_ctz(bitfield) : count;
+        memmove(keys + pos + 1, keys + pos, count - pos);
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(children[0]));
+        keys[pos] = keyByteFlipped;
+        children[pos] = n;
+        count++;
+    }
+
+    template<class NODE>
+    void N32::copyTo(NODE *n) const {
+        for (unsigned i = 0; i < count; i++) {
+            n->insert(flipSign(keys[i]), children[i]);
+        }
+    }
+
+    bool N32::change(uint8_t key, N *val) {
+        ChildRef<N> *childPos = const_cast<ChildRef<N> *>(getChildPos(key));
+        assert(childPos != nullptr);
+        *childPos = val;
+        return true;
+    }
+
+    const ChildRef<N> *N32::getChildPos(const uint8_t k) const {
+        uint32_t bitfield = NodeSearch::equalMask32(keys, flipSign(k)) & usedMask();
+        if (bitfield) {
+            return &children[__builtin_ctz(bitfield)];
+        } else {
+            return nullptr;
+        }
+    }
+
+    N *N32::getChild(const uint8_t k) const {
+        const ChildRef<N> *childPos = getChildPos(k);
+        if (childPos == nullptr) {
+            return nullptr;
+        } else {
+            return *childPos;
+        }
+    }
+
+    void N32::remove(uint8_t k) {
+        const ChildRef<N> *leafPlace = getChildPos(k);
+        assert(leafPlace != nullptr);
+        std::size_t pos = leafPlace - children;
+        memmove(keys + pos, keys + pos + 1, count - pos - 1);
+        memmove(children + pos, children + pos + 1, (count - pos - 1) * sizeof(children[0]));
+        count--;
+        assert(getChild(k) == nullptr);
+    }
+
+    N *N32::getAnyChild() const {
+        for (int i = 0; i < count; ++i) {
+            if (N::isLeaf(children[i])) {
+                return children[i];
+            }
+        }
+        return children[0];
+    }
+
+    std::tuple<N *, uint8_t> N32::getSecondChild(const uint8_t key) const {
+        uint8_t keyByteFlipped = flipSign(key);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (keys[i] != keyByteFlipped) {
+                return std::make_tuple(children[i], flipSign(keys[i]));
+            }
+        }
+        return std::make_tuple(nullptr, 0);
+    }
+
+    void N32::deleteChildren() {
+        for (std::size_t i = 0; i < count; ++i) {
+            N::deleteChildren(children[i]);
+            N::deleteNode(children[i]);
+        }
+    }
+
+    uint64_t N32::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                          uint32_t &childrenCount) const {
+        restart:
+        bool needRestart = false;
+        uint64_t v;
+        v = readLockOrRestart(needRestart);
+        if (needRestart) goto restart;
+        childrenCount = 0;
+        // the keys are sorted, the ones in the range are consecutive
+        uint32_t bitfield = NodeSearch::rangeMask32(keys, flipSign(start), flipSign(end)) & usedMask();
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = __builtin_ctz(bitfield);
+            children[childrenCount] = std::make_tuple(flipSign(keys[pos]), this->children[pos]);
+            childrenCount++;
+        }
+        readUnlockOrRestart(v, needRestart);
+        if (needRestart) goto restart;
+        return v;
+    }
+}
@@ -15,7 +15,7 @@ namespace ART_OLC {
         return count == 4;
     }
 
-    bool N4::isUnderfull() const {
+    bool N4::isUnderfull(ShrinkPolicy) const {
         return false;
     }
 
@@ -23,7 +23,7 @@ namespace ART_OLC {
         unsigned pos;
         for (pos = 0; (pos < count) && (keys[pos] < key); pos++);
         memmove(keys + pos + 1, keys + pos, count - pos);
-        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(N*));
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(children[0]));
         keys[pos] = key;
         children[pos] = n;
         count++;
@@ -48,10 +48,9 @@ namespace ART_OLC {
     }
 
     N *N4::getChild(const uint8_t k) const {
-        for (uint32_t i = 0; i < count; ++i) {
-            if (keys[i] == k) {
-                return children[i];
-            }
+        uint32_t bitfield = NodeSearch::equalMask4(keys, k) & ((1u << count) - 1);
+        if (bitfield != 0) {
+            return children[__builtin_ctz(bitfield)];
         }
         return nullptr;
     }
@@ -60,7 +59,7 @@ namespace ART_OLC {
         for (uint32_t i = 0; i < count; ++i) {
             if (keys[i] == k) {
                 memmove(keys + i, keys + i + 1, count - i - 1);
-                memmove(children + i, children + i + 1, (count - i - 1) * sizeof(N *));
+                memmove(children + i, children + i + 1, (count - i - 1) * sizeof(children[0]));
                 count--;
                 return;
             }
@@ -8,8 +8,16 @@ namespace ART_OLC {
         return count == 48;
     }
 
-    bool N48::isUnderfull() const {
-        return count == 12;
+    bool N48::isUnderfull(ShrinkPolicy shrinkPolicy) const {
+        switch (shrinkPolicy) {
+            case ShrinkPolicy::Eager:
+                return count == 24;
+            case ShrinkPolicy::Hysteresis:
+                return count == 17;
+            case ShrinkPolicy::Lazy:
+                break;
+        }
+        return false;
     }
 
     void N48::insert(uint8_t key, N *n) {
@@ -24,8 +32,10 @@ namespace ART_OLC {
 
     template<class NODE>
     void N48::copyTo(NODE *n) const {
-        for (unsigned i = 0; i < 256; i++) {
-            if (childIndex[i] != emptyMarker) {
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = 0; base < 256; base += 64) {
+            for (uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker); mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
                 n->insert(i, children[childIndex[i]]);
             }
         }
@@ -54,18 +64,28 @@ namespace ART_OLC {
 
     N *N48::getAnyChild() const {
         N *anyChild = nullptr;
-        for (unsigned i = 0; i < 256; i++) {
-            if (childIndex[i] != emptyMarker) {
-                if (N::isLeaf(children[childIndex[i]])) {
-                    return children[childIndex[i]];
-                } else {
-                    anyChild = children[childIndex[i]];
-                };
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = 0; base < 256; base += 64) {
+            for (uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker); mask != 0; mask &= mask - 1) {
+                N *child = children[childIndex[base + __builtin_ctzll(mask)]];
+                if (N::isLeaf(child)) {
+                    return child;
+                }
+                anyChild = child;
             }
         }
         return anyChild;
     }
 
+    std::tuple<N *, uint8_t> N48::getSecondChild(const uint8_t key) const {
+        for (unsigned i = 0; i < 256; i++) {
+            if (i != key && childIndex[i] != emptyMarker) {
+                return std::make_tuple(children[childIndex[i]], i);
+            }
+        }
+        return std::make_tuple(nullptr, 0);
+    }
+
     void N48::deleteChildren() {
         for (unsigned i = 0; i < 256; i++) {
             if (childIndex[i] != emptyMarker) {
@@ -83,8 +103,17 @@ namespace ART_OLC {
         v = readLockOrRestart(needRestart);
         if (needRestart) goto restart;
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
-            if (this->childIndex[i] != emptyMarker) {
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        for (unsigned base = start & ~63u; base <= end; base += 64) {
+            uint64_t mask = nonEmptyMask(childIndex + base, emptyMarker);
+            if (base < start) {
+                mask &= ~0ull << (start - base);
+            }
+            if (end < base + 63) {
+                mask &= ~0ull >> (base + 63 - end);
+            }
+            for (; mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
                 children[childrenCount] = std::make_tuple(i, this->children[this->childIndex[i]]);
                 childrenCount++;
             }
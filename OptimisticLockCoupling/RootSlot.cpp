@@ -0,0 +1,63 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_OLC {
+
+    void RootSlot::setKey(uint8_t key) {
+        this->key = key;
+    }
+
+    void RootSlot::insert(uint8_t key, N *n) {
+        assert(key == this->key && count == 0);
+        (void) key;
+        child = n;
+        count = 1;
+    }
+
+    bool RootSlot::change(uint8_t key, N *val) {
+        assert(key == this->key);
+        (void) key;
+        child = val;
+        return true;
+    }
+
+    N *RootSlot::getChild(const uint8_t k) const {
+        return k == key ? static_cast<N *>(child) : nullptr;
+    }
+
+    void RootSlot::remove(uint8_t k) {
+        assert(k == key);
+        (void) k;
+        child = nullptr;
+        count = 0;
+    }
+
+    N *RootSlot::getAnyChild() const {
+        return child;
+    }
+
+    void RootSlot::deleteChildren() {
+        if (count != 0) {
+            N::deleteChildren(child);
+            N::deleteNode(child);
+        }
+    }
+
+    uint64_t RootSlot::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                                   uint32_t &childrenCount) const {
+        restart:
+        bool needRestart = false;
+        uint64_t v;
+        v = readLockOrRestart(needRestart);
+        if (needRestart) goto restart;
+        childrenCount = 0;
+        if (count != 0 && key >= start && key <= end) {
+            children[0] = std::make_tuple(key, child);
+            childrenCount = 1;
+        }
+        readUnlockOrRestart(v, needRestart);
+        if (needRestart) goto restart;
+        return v;
+    }
+}
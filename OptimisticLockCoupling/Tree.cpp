@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <algorithm>
 #include <functional>
+#include <thread>
 #include "Tree.h"
 #include "N.cpp"
 #include "../Epoche.cpp"
@@ -9,21 +10,265 @@
 
 namespace ART_OLC {
 
-    Tree::Tree(LoadKeyFunction loadKey) : root(new N256( nullptr, 0)), loadKey(loadKey) {
+    template<typename Backoff>
+    BasicTree<Backoff>::BasicTree(LoadKeyFunction loadKey, ReclamationMode reclamationMode,
+                                  NodeAllocator nodeAllocator, RootTable rootTable, ShrinkPolicy shrinkPolicy)
+            : root(rootTable == RootTable::None ? new(allocateNodeMemory(sizeof(N256))) N256(nullptr, 0) : nullptr),
+              rootSlots(rootTable == RootTable::None ? nullptr : static_cast<RootSlot *>(allocateNodeMemory(
+                      sizeof(RootSlot) << (8 * static_cast<uint32_t>(rootTable))))),
+              rootTableLevels(static_cast<uint32_t>(rootTable)), shrinkPolicy(shrinkPolicy), loadKey(loadKey),
+              epoche(256, reclamationMode, nodeAllocator) {
+        for (uint32_t i = 0; i < (rootSlots != nullptr ? 1u << (8 * rootTableLevels) : 0u); ++i) {
+            new(&rootSlots[i]) RootSlot();
+            rootSlots[i].setKey(static_cast<uint8_t>(i));
+        }
     }
 
-    Tree::~Tree() {
-        N::deleteChildren(root);
+    template<typename Backoff>
+    BasicTree<Backoff>::~BasicTree() {
+        if (rootSlots != nullptr) {
+            uint32_t slots = 1u << (8 * rootTableLevels);
+            for (uint32_t i = 0; i < slots; ++i) {
+                if (epoche.getNodeAllocator() == NodeAllocator::Heap) {
+                    N::deleteChildren(&rootSlots[i]);
+                }
+                rootSlots[i].~RootSlot();
+            }
+            freeNodeMemory(rootSlots, sizeof(RootSlot) * slots);
+            return;
+        }
+        // nodes from the arena are freed with it, only the root comes from the heap
+        if (epoche.getNodeAllocator() == NodeAllocator::Heap) {
+            N::deleteChildren(root);
+        }
         N::deleteNode(root);
     }
 
-    ThreadInfo Tree::getThreadInfo() {
+    template<typename Backoff>
+    uint32_t BasicTree<Backoff>::getRootSlot(const Key &k, uint8_t fill) const {
+        uint32_t slot = 0;
+        for (uint32_t i = 0; i < rootTableLevels; ++i) {
+            slot = slot << 8 | (i < k.getKeyLen() ? k[i] : fill);
+        }
+        return slot;
+    }
+
+    template<typename Backoff>
+    N *BasicTree<Backoff>::getStartNode(const Key &k, uint32_t &level) const {
+        if (rootSlots == nullptr) {
+            level = 0;
+            return root;
+        }
+        level = rootTableLevels - 1;
+        return &rootSlots[getRootSlot(k, 0)];
+    }
+
+    template<typename Backoff>
+    ThreadInfo BasicTree<Backoff>::getThreadInfo() {
         return ThreadInfo(this->epoche);
     }
 
-    TID Tree::lookup(const Key &k, ThreadInfo &threadEpocheInfo) const {
+    template<typename Backoff>
+    const Epoche &BasicTree<Backoff>::getEpoche() const {
+        return epoche;
+    }
+
+    template<typename Backoff>
+    Epoche &BasicTree<Backoff>::getEpoche() {
+        return epoche;
+    }
+
+    template<typename Backoff>
+    MemoryUsage BasicTree<Backoff>::memoryUsage() const {
+        MemoryUsage usage = epoche.getMemoryUsage();
+        // allocated with the tree, never replaced
+        if (rootSlots != nullptr) {
+            usage.get(sizeof(RootSlot)).liveBytes += sizeof(RootSlot) << (8 * rootTableLevels);
+        } else {
+            usage.get(sizeof(N256)).liveBytes += sizeof(N256);
+        }
+        return usage;
+    }
+
+    template<typename Backoff>
+    TreeStats BasicTree<Backoff>::collectStats(unsigned threads) const {
+        auto visit = [](const N *node, uint32_t level, TreeStats &stats, std::tuple<uint8_t, N *> children[],
+                        uint32_t &childrenCount) {
+            N::getChildren(node, 0u, 255u, children, childrenCount);
+            stats.addNode(static_cast<unsigned>(node->getType()), N::getNodeSize(node), level, childrenCount,
+                          node->getPrefixLength(), maxStoredPrefixLength);
+        };
+        if (rootSlots != nullptr) {
+            // the slots are the top level
+            std::vector<std::pair<N *, uint32_t>> slots;
+            for (uint32_t i = 0; i < 1u << (8 * rootTableLevels); ++i) {
+                slots.emplace_back(&rootSlots[i], 0);
+            }
+            return collectTreeStats(std::move(slots), threads, visit);
+        }
+        return collectTreeStats(root, threads, visit);
+    }
+
+    template<typename Backoff>
+    std::size_t BasicTree<Backoff>::compact(ThreadInfo &threadInfo) {
+        std::size_t compacted = 0;
+        if (rootSlots != nullptr) {
+            for (uint32_t i = 0; i < 1u << (8 * rootTableLevels); ++i) {
+                EpocheGuard epocheGuard(threadInfo);
+                compacted += compactChild(&rootSlots[i], static_cast<uint8_t>(i), 1, threadInfo);
+            }
+            return compacted;
+        }
+        std::tuple<uint8_t, N *> children[256];
+        uint32_t childrenCount = 0;
+        {
+            EpocheGuardReadonly epocheGuard(threadInfo);
+            N::getChildren(root, 0, 255, children, childrenCount);
+        }
+        for (uint32_t i = 0; i < childrenCount; ++i) {
+            EpocheGuard epocheGuard(threadInfo);
+            compacted += compactChild(root, std::get<0>(children[i]), 1, threadInfo);
+        }
+        return compacted;
+    }
+
+    template<typename Backoff>
+    std::size_t BasicTree<Backoff>::compactChild(N *parent, uint8_t key, uint32_t depth, ThreadInfo &threadInfo) {
+        bool needRestart = false;
+        uint64_t parentVersion = parent->readLockOrRestart(needRestart);
+        if (needRestart) return 0;
+        N *node = N::getChild(key, parent);
+        parent->checkOrRestart(parentVersion, needRestart);
+        if (needRestart || node == nullptr || N::isLeaf(node) || node->getType() == NTypes::Bucket) return 0;
+        uint64_t v = node->readLockOrRestart(needRestart);
+        if (needRestart) return 0;
+
+        std::size_t compacted = 0;
+        NTypes type = N::getCompactType(node);
+        if (type != node->getType()) {
+            parent->upgradeToWriteLockOrRestart(parentVersion, needRestart);
+            if (needRestart) return 0;
+            node->upgradeToWriteLockOrRestart(v, needRestart);
+            if (needRestart) {
+                parent->writeUnlock();
+                return 0;
+            }
+            N *nSmall = N::copyToSmaller(node, type, depth, threadInfo);
+            N::change(parent, key, nSmall);
+            node->writeUnlockObsolete();
+            epoche.markNodeForDeletion(node, N::getNodeSize(node), threadInfo);
+            parent->writeUnlock();
+            node = nSmall;
+            compacted++;
+            v = node->readLockOrRestart(needRestart);
+            if (needRestart) return compacted;
+        }
+
+        // a subtree that changes meanwhile is left for the next pass
+        std::tuple<uint8_t, N *> children[256];
+        uint32_t childrenCount = 0;
+        N::getChildrenOptimistic(node, children, childrenCount);
+        node->checkOrRestart(v, needRestart);
+        if (needRestart) return compacted;
+        for (uint32_t i = 0; i < childrenCount; ++i) {
+            if (!N::isLeaf(std::get<1>(children[i]))) {
+                compacted += compactChild(node, std::get<0>(children[i]), depth + 1, threadInfo);
+            }
+        }
+        return compacted;
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::RestartPath::push(N *node, uint64_t version, uint32_t level, uint8_t nodeKey,
+                                               bool optimisticPrefixMatch) {
+#ifndef ART_RESTART_FROM_ROOT
+        if (depth < maxDepth) {
+            entries[depth] = {node, version, level, nodeKey, optimisticPrefixMatch};
+            depth++;
+        }
+#else
+        (void) node;
+        (void) version;
+        (void) level;
+        (void) nodeKey;
+        (void) optimisticPrefixMatch;
+#endif
+    }
+
+    template<typename Backoff>
+    uint32_t BasicTree<Backoff>::RestartPath::resume() {
+        // a node can be entered again without revalidation if its parent did not change since it was read,
+        // the epoche guard of the operation keeps all nodes on the path alive
+        for (uint32_t i = depth; i > 1; --i) {
+            bool needRestart = false;
+            entries[i - 2].node->checkOrRestart(entries[i - 2].version, needRestart);
+            if (!needRestart) {
+                depth = i - 1;
+                return depth;
+            }
+        }
+        depth = 0;
+        return 0;
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::RestartPath::truncate(uint32_t matchingBytes, bool pessimistic) {
+        uint32_t i = 0;
+        while (i < depth && entries[i].level <= matchingBytes && !(pessimistic && entries[i].optimisticPrefixMatch)) {
+            i++;
+        }
+        depth = i;
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::RestartPath::clear() {
+        depth = 0;
+    }
+
+    template<typename Backoff>
+    const typename BasicTree<Backoff>::RestartPath::Entry &BasicTree<Backoff>::RestartPath::operator[](uint32_t i) const {
+        return entries[i];
+    }
+
+    template<typename Backoff>
+    typename BasicTree<Backoff>::RestartPath &BasicTree<Backoff>::Finger::prepare(const Key &k,
+                                                                                 const EpocheSession &session,
+                                                                                 bool pessimistic) {
+        if (session.getId() != sessionId) {
+            path.clear();
+            sessionId = session.getId();
+        } else {
+            uint32_t matchingBytes = NodeSearch::mismatch(k.getData(), lastKey.getData(),
+                                                          std::min(k.getKeyLen(), lastKey.getKeyLen()));
+            path.truncate(matchingBytes, pessimistic);
+        }
+        lastKey = k;
+        return path;
+    }
+
+    template<typename Backoff>
+    TID BasicTree<Backoff>::lookup(const Key &k, ThreadInfo &threadEpocheInfo) const {
         EpocheGuardReadonly epocheGuard(threadEpocheInfo);
+        return lookupInEpoche(k);
+    }
+
+    template<typename Backoff>
+    TID BasicTree<Backoff>::lookup(const Key &k, EpocheSession &) const {
+        return lookupInEpoche(k);
+    }
+
+    template<typename Backoff>
+    TID BasicTree<Backoff>::lookup(const Key &k, EpocheSession &session, Finger &finger) const {
+        return lookupInEpoche(k, &finger.prepare(k, session, false));
+    }
+
+    template<typename Backoff>
+    TID BasicTree<Backoff>::lookupInEpoche(const Key &k, RestartPath *fingerPath) const {
+        RestartPath ownPath;
+        RestartPath &path = fingerPath != nullptr ? *fingerPath : ownPath;
+        uint32_t restarts = 0;
         restart:
+        if (restarts++ > 0) Backoff::spin(restarts - 1);
         bool needRestart = false;
 
         N *node;
@@ -32,10 +277,17 @@ namespace ART_OLC {
         uint32_t level = 0;
         bool optimisticPrefixMatch = false;
 
-        node = root;
-        v = node->readLockOrRestart(needRestart);
+        node = getStartNode(k, level);
+        if (auto resumeAt = path.resume()) {
+            node = path[resumeAt].node;
+            level = path[resumeAt].level;
+            optimisticPrefixMatch = path[resumeAt].optimisticPrefixMatch;
+        }
+        v = node->readLockOrRestart<Backoff>(needRestart);
         if (needRestart) goto restart;
         while (true) {
+            // the key byte in the parent lets an insert resume at the path of a lookup
+            path.push(node, v, level, level > 0 ? k[level - 1] : 0, optimisticPrefixMatch);
             switch (checkPrefix(node, k, level)) { // increases level
                 case CheckPrefixResult::NoMatch:
                     node->readUnlockOrRestart(v, needRestart);
@@ -48,6 +300,12 @@ namespace ART_OLC {
                     if (k.getKeyLen() <= level) {
                         return 0;
                     }
+                    if (node->getType() == NTypes::Bucket) {
+                        TID tid = lookupBucket(static_cast<const Bucket *>(node), v, k, level, optimisticPrefixMatch,
+                                               needRestart);
+                        if (needRestart) goto restart;
+                        return tid;
+                    }
                     parentNode = node;
                     node = N::getChild(k[level], parentNode);
                     parentNode->checkOrRestart(v,needRestart);
@@ -62,13 +320,14 @@ namespace ART_OLC {
 
                         TID tid = N::getLeaf(node);
                         if (level < k.getKeyLen() - 1 || optimisticPrefixMatch) {
-                            return checkKey(tid, k);
+                            // a mismatching fingerprint saves loading the key
+                            return N::matchesFingerprint(node, k) ? checkKey(tid, k) : 0;
                         }
                         return tid;
                     }
                     level++;
             }
-            uint64_t nv = node->readLockOrRestart(needRestart);
+            uint64_t nv = node->readLockOrRestart<Backoff>(needRestart);
             if (needRestart) goto restart;
 
             parentNode->readUnlockOrRestart(v, needRestart);
@@ -77,8 +336,138 @@ namespace ART_OLC {
         }
     }
 
-    bool Tree::lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[],
+    template<typename Backoff>
+    TID BasicTree<Backoff>::lookupBucket(const Bucket *b, uint64_t v, const Key &k, uint32_t level,
+                                         bool optimisticPrefixMatch, bool &needRestart) const {
+        uint32_t partialKey = Bucket::getPartialKey(k, level);
+        N *candidates[maxBucketSize];
+        uint32_t candidatesCount = 0;
+        for (uint32_t i = b->lowerBound(partialKey);
+             i < std::min(b->getCount(), b->getCapacity()) && b->getPartialKeys()[i] == partialKey; ++i) {
+            candidates[candidatesCount] = b->getLeaves()[i];
+            candidatesCount++;
+        }
+        b->readUnlockOrRestart(v, needRestart);
+        if (needRestart) return 0;
+
+        // the partial key covers the whole rest of a key that is known to match up to the bucket
+        if (!optimisticPrefixMatch && k.getKeyLen() <= level + sizeof(partialKey)) {
+            return candidatesCount > 0 ? N::getLeaf(candidates[0]) : 0;
+        }
+        for (uint32_t i = 0; i < candidatesCount; ++i) {
+            if (N::matchesFingerprint(candidates[i], k)) {
+                if (TID tid = checkKey(N::getLeaf(candidates[i]), k)) {
+                    return tid;
+                }
+            }
+        }
+        return 0;
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::copyBucket(const N *node, uint32_t level, const Key *start, const Key *end,
+                                        const std::function<void(const N *)> &copy, const TID &toContinue) const {
+        uint32_t partialKeys[maxBucketSize];
+        N *leaves[maxBucketSize];
+        uint32_t count = 0;
+        static_cast<const Bucket *>(node)->getEntries(partialKeys, leaves, count);
+        uint32_t startKey = start != nullptr ? Bucket::getPartialKey(*start, level) : 0;
+        uint32_t endKey = end != nullptr ? Bucket::getPartialKey(*end, level) : 0;
+        for (uint32_t i = 0; i < count && toContinue == 0; ++i) {
+            // only leaves with the partial key of a bound have to be compared with the whole bound
+            Key kt;
+            if (start != nullptr && partialKeys[i] <= startKey) {
+                if (partialKeys[i] < startKey) {
+                    continue;
+                }
+                loadKey(N::getLeaf(leaves[i]), kt);
+                if (kt < *start) {
+                    continue;
+                }
+            }
+            if (end != nullptr && partialKeys[i] >= endKey) {
+                if (partialKeys[i] > endKey) {
+                    break;
+                }
+                if (kt.getKeyLen() == 0) {
+                    loadKey(N::getLeaf(leaves[i]), kt);
+                }
+                if (!(kt < *end)) {
+                    break;
+                }
+            }
+            copy(leaves[i]);
+        }
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::scanRootSlots(uint32_t startSlot, uint32_t endSlot, const FindBound &findStart,
+                                           const FindBound &findEnd, const std::function<void(const N *)> &copy,
+                                           const TID &toContinue) const {
+        for (uint32_t s = startSlot; s <= endSlot && toContinue == 0; ++s) {
+            std::tuple<uint8_t, N *> children[1];
+            uint32_t childrenCount = 0;
+            uint64_t v = N::getChildren(&rootSlots[s], 0, 255, children, childrenCount);
+            if (childrenCount == 0) {
+                continue;
+            }
+            const uint8_t k = std::get<0>(children[0]);
+            N *n = std::get<1>(children[0]);
+            if (s == startSlot) {
+                findStart(n, k, rootTableLevels, &rootSlots[s], v);
+            } else if (s == endSlot && findEnd) {
+                findEnd(n, k, rootTableLevels, &rootSlots[s], v);
+            } else {
+                copy(n);
+            }
+        }
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[],
                                 std::size_t resultSize, std::size_t &resultsFound, ThreadInfo &threadEpocheInfo) const {
+        if (epoche.isBounded()) {
+            EpocheSession session(threadEpocheInfo);
+            return lookupRangeBounded(start, end, continueKey, result, resultSize, resultsFound, session);
+        }
+        EpocheGuard epocheGuard(threadEpocheInfo);
+        return lookupRangeInEpoche(start, end, continueKey, result, resultSize, resultsFound);
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound, EpocheSession &session) const {
+        if (epoche.isBounded()) {
+            return lookupRangeBounded(start, end, continueKey, result, resultSize, resultsFound, session);
+        }
+        return lookupRangeInEpoche(start, end, continueKey, result, resultSize, resultsFound);
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRangeBounded(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound, EpocheSession &session) const {
+        const std::size_t chunkSize = 1024;
+        Key chunkStart = start;
+        resultsFound = 0;
+        while (true) {
+            std::size_t chunkFound = 0;
+            bool more = lookupRangeInEpoche(chunkStart, end, continueKey, result + resultsFound,
+                                            std::min(chunkSize, resultSize - resultsFound), chunkFound);
+            resultsFound += chunkFound;
+            if (!more || resultsFound == resultSize) {
+                return more;
+            }
+            // no node is held between chunks, the next one starts at the first key not copied yet
+            if (epoche.isOverBudget()) {
+                session.refresh();
+            }
+            chunkStart = continueKey;
+        }
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRangeInEpoche(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound) const {
         for (uint32_t i = 0; i < std::min(start.getKeyLen(), end.getKeyLen()); ++i) {
             if (start[i] > end[i]) {
                 resultsFound = 0;
@@ -87,7 +476,6 @@ namespace ART_OLC {
                 break;
             }
         }
-        EpocheGuard epocheGuard(threadEpocheInfo);
         TID toContinue = 0;
         std::function<void(const N *)> copy = [&result, &resultSize, &resultsFound, &toContinue, &copy](const N *node) {
             if (N::isLeaf(node)) {
@@ -122,7 +510,7 @@ namespace ART_OLC {
             {
                 readAgain:
                 bool needRestart = false;
-                v = node->readLockOrRestart(needRestart);
+                v = node->readLockOrRestart<Backoff>(needRestart);
                 if (needRestart) goto readAgain;
 
                 prefixResult = checkPrefixCompare(node, start, 0, level, loadKey, needRestart);
@@ -131,7 +519,7 @@ namespace ART_OLC {
                 parentNode->readUnlockOrRestart(vp, needRestart);
                 if (needRestart) {
                     readParentAgain:
-                    vp = parentNode->readLockOrRestart(needRestart);
+                    vp = parentNode->readLockOrRestart<Backoff>(needRestart);
                     if (needRestart) goto readParentAgain;
 
                     node = N::getChild(nodeK, parentNode);
@@ -157,6 +545,10 @@ namespace ART_OLC {
                     copy(node);
                     break;
                 case PCCompareResults::Equal: {
+                    if (node->getType() == NTypes::Bucket) {
+                        copyBucket(node, level, &start, nullptr, copy, toContinue);
+                        break;
+                    }
                     uint8_t startLevel = (start.getKeyLen() > level) ? start[level] : 0;
                     std::tuple<uint8_t, N *> children[256];
                     uint32_t childrenCount = 0;
@@ -189,7 +581,7 @@ namespace ART_OLC {
             {
                 readAgain:
                 bool needRestart = false;
-                v = node->readLockOrRestart(needRestart);
+                v = node->readLockOrRestart<Backoff>(needRestart);
                 if (needRestart) goto readAgain;
 
                 prefixResult = checkPrefixCompare(node, end, 255, level, loadKey, needRestart);
@@ -198,7 +590,7 @@ namespace ART_OLC {
                 parentNode->readUnlockOrRestart(vp, needRestart);
                 if (needRestart) {
                     readParentAgain:
-                    vp = parentNode->readLockOrRestart(needRestart);
+                    vp = parentNode->readLockOrRestart<Backoff>(needRestart);
                     if (needRestart) goto readParentAgain;
 
                     node = N::getChild(nodeK, parentNode);
@@ -222,6 +614,10 @@ namespace ART_OLC {
                     copy(node);
                     break;
                 case PCCompareResults::Equal: {
+                    if (node->getType() == NTypes::Bucket) {
+                        copyBucket(node, level, nullptr, &end, copy, toContinue);
+                        break;
+                    }
                     uint8_t endLevel = (end.getKeyLen() > level) ? end[level] : 255;
                     std::tuple<uint8_t, N *> children[256];
                     uint32_t childrenCount = 0;
@@ -257,12 +653,28 @@ namespace ART_OLC {
         uint64_t v = 0;
         uint64_t vp;
 
+        if (rootSlots != nullptr) {
+            uint32_t startSlot = getRootSlot(start, 0);
+            uint32_t endSlot = getRootSlot(end, 255);
+            if (startSlot != endSlot) {
+                scanRootSlots(startSlot, endSlot, findStart, findEnd, copy, toContinue);
+                if (toContinue != 0) {
+                    loadKey(toContinue, continueKey);
+                    return true;
+                }
+                return false;
+            }
+            // below a single slot the range continues like below a single child of the root
+            nextNode = &rootSlots[startSlot];
+            level = rootTableLevels - 1;
+        }
+
         while (true) {
             parentNode = node;
             vp = v;
             node = nextNode;
             PCEqualsResults prefixResult;
-            v = node->readLockOrRestart(needRestart);
+            v = node->readLockOrRestart<Backoff>(needRestart);
             if (needRestart) goto restart;
             prefixResult = checkPrefixEquals(node, level, start, end, loadKey, needRestart);
             if (needRestart) goto restart;
@@ -282,6 +694,10 @@ namespace ART_OLC {
                     break;
                 }
                 case PCEqualsResults::BothMatch: {
+                    if (node->getType() == NTypes::Bucket) {
+                        copyBucket(node, level, &start, &end, copy, toContinue);
+                        break;
+                    }
                     uint8_t startLevel = (start.getKeyLen() > level) ? start[level] : 0;
                     uint8_t endLevel = (end.getKeyLen() > level) ? end[level] : 255;
                     if (startLevel != endLevel) {
@@ -322,10 +738,23 @@ namespace ART_OLC {
         }
     }
 
-    bool Tree::lookupRange(const Key &start, TID result[],
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRange(const Key &start, TID result[],
                                 std::size_t resultSize, std::size_t &resultsFound, ThreadInfo &threadEpocheInfo) const {
-        
         EpocheGuard epocheGuard(threadEpocheInfo);
+        return lookupRangeInEpoche(start, result, resultSize, resultsFound);
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRange(const Key &start, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound, EpocheSession &) const {
+        return lookupRangeInEpoche(start, result, resultSize, resultsFound);
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::lookupRangeInEpoche(const Key &start, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound) const {
+        
         TID toContinue = 0;
         std::function<void(const N *)> copy = [&result, &resultSize, &resultsFound, &toContinue, &copy](const N *node) {
             if (N::isLeaf(node)) {
@@ -360,7 +789,7 @@ namespace ART_OLC {
             {
                 readAgain:
                 bool needRestart = false;
-                v = node->readLockOrRestart(needRestart);
+                v = node->readLockOrRestart<Backoff>(needRestart);
                 if (needRestart) goto readAgain;
 
                 prefixResult = checkPrefixCompare(node, start, 0, level, loadKey, needRestart);
@@ -369,7 +798,7 @@ namespace ART_OLC {
                 parentNode->readUnlockOrRestart(vp, needRestart);
                 if (needRestart) {
                     readParentAgain:
-                    vp = parentNode->readLockOrRestart(needRestart);
+                    vp = parentNode->readLockOrRestart<Backoff>(needRestart);
                     if (needRestart) goto readParentAgain;
 
                     node = N::getChild(nodeK, parentNode);
@@ -395,6 +824,10 @@ namespace ART_OLC {
                     copy(node);
                     break;
                 case PCCompareResults::Equal: {
+                    if (node->getType() == NTypes::Bucket) {
+                        copyBucket(node, level, &start, nullptr, copy, toContinue);
+                        break;
+                    }
                     uint8_t startLevel = (start.getKeyLen() > level) ? start[level] : 0;
                     std::tuple<uint8_t, N *> children[256];
                     uint32_t childrenCount = 0;
@@ -430,12 +863,23 @@ namespace ART_OLC {
         uint64_t v = 0;
         uint64_t vp;
 
+        if (rootSlots != nullptr) {
+            uint32_t startSlot = getRootSlot(start, 0);
+            uint32_t endSlot = (1u << (8 * rootTableLevels)) - 1;
+            if (startSlot != endSlot) {
+                scanRootSlots(startSlot, endSlot, findStart, nullptr, copy, toContinue);
+                return false;
+            }
+            nextNode = &rootSlots[startSlot];
+            level = rootTableLevels - 1;
+        }
+
         while (true) {
             parentNode = node;
             vp = v;
             node = nextNode;
             PCCompareResults compareResult;
-            v = node->readLockOrRestart(needRestart);
+            v = node->readLockOrRestart<Backoff>(needRestart);
             if (needRestart) goto restart;
             compareResult = checkPrefixCompare(node, start, 0, level, loadKey, needRestart);
             if (needRestart) goto restart;
@@ -452,6 +896,12 @@ namespace ART_OLC {
                 }
                 case PCCompareResults::Equal:
                 case PCCompareResults::Bigger: {
+                    if (node->getType() == NTypes::Bucket) {
+                        // behind a bigger prefix every leaf of the bucket is in the range
+                        copyBucket(node, level, compareResult == PCCompareResults::Equal ? &start : nullptr, nullptr,
+                                   copy, toContinue);
+                        break;
+                    }
                     uint8_t startLevel = (start.getKeyLen() > level) ? start[level] : 0;
                     uint8_t endLevel = 255;
                     if (startLevel != endLevel) {
@@ -489,7 +939,8 @@ namespace ART_OLC {
 
 
 
-    TID Tree::checkKey(const TID tid, const Key &k) const {
+    template<typename Backoff>
+    TID BasicTree<Backoff>::checkKey(const TID tid, const Key &k) const {
         Key kt;
         this->loadKey(tid, kt);
         if (k == kt) {
@@ -498,24 +949,152 @@ namespace ART_OLC {
         return 0;
     }
 
-    void Tree::insert(const Key &k, TID tid, ThreadInfo &epocheInfo) {
+    template<typename Backoff>
+    void BasicTree<Backoff>::insert(const Key &k, TID tid, ThreadInfo &epocheInfo) {
         EpocheGuard epocheGuard(epocheInfo);
+        insertInEpoche(k, tid, epocheInfo);
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::insert(const Key &k, TID tid, EpocheSession &session) {
+        insertInEpoche(k, tid, session.getThreadInfo());
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::insert(const Key &k, TID tid, EpocheSession &session, Finger &finger) {
+        uint64_t prefix = getAppendPrefix(k);
+        if (prefix < finger.lastPrefix) {
+            finger.ascending = 0;
+        } else if (finger.ascending < appendRun) {
+            finger.ascending++;
+        }
+        finger.lastPrefix = prefix;
+        bool append = finger.ascending == appendRun;
+        if (append && prefix >= combiner.maxPrefix.load(std::memory_order_relaxed) &&
+            insertCombined(k, tid, session, finger)) {
+            return;
+        }
+        insertInEpoche(k, tid, session.getThreadInfo(), &finger.prepare(k, session, true), append);
+    }
+
+    template<typename Backoff>
+    uint64_t BasicTree<Backoff>::getAppendPrefix(const Key &k) {
+        uint64_t prefix = 0;
+        for (uint32_t i = 0; i < 8; ++i) {
+            prefix = prefix << 8 | (i < k.getKeyLen() ? k[i] : 0);
+        }
+        return prefix;
+    }
+
+    template<typename Backoff>
+    bool BasicTree<Backoff>::insertCombined(const Key &k, TID tid, EpocheSession &session, Finger &finger) {
+        using State = typename AppendCombiner::State;
+        if (!combiner.locked.load(std::memory_order_relaxed) &&
+            !combiner.locked.exchange(true, std::memory_order_acquire)) {
+            insertInEpoche(k, tid, session.getThreadInfo(), &finger.prepare(k, session, true), true);
+            combineAppends(session, finger);
+            combiner.locked.store(false, std::memory_order_release);
+            return true;
+        }
+        if (finger.slot == AppendCombiner::maxSlots) {
+            finger.slot = combiner.usedSlots.fetch_add(1) % AppendCombiner::maxSlots;
+        }
+        auto &request = combiner.requests[finger.slot];
+        State expected = State::Free;
+        if (!request.state.compare_exchange_strong(expected, State::Claimed, std::memory_order_acquire)) {
+            return false;
+        }
+        request.key = &k;
+        request.tid = tid;
+        request.state.store(State::Pending, std::memory_order_release);
+        while (request.state.load(std::memory_order_acquire) != State::Done) {
+            if (!combiner.locked.load(std::memory_order_relaxed) &&
+                !combiner.locked.exchange(true, std::memory_order_acquire)) {
+                combineAppends(session, finger);
+                combiner.locked.store(false, std::memory_order_release);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        request.state.store(State::Free, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::combineAppends(EpocheSession &session, Finger &finger) {
+        using State = typename AppendCombiner::State;
+        struct Append {
+            const Key *key;
+            TID tid;
+            uint32_t slot;
+        };
+        Append appends[AppendCombiner::maxSlots];
+        uint32_t count = 0;
+        uint32_t slots = combiner.usedSlots.load(std::memory_order_relaxed);
+        slots = slots < AppendCombiner::maxSlots ? slots : AppendCombiner::maxSlots;
+        for (uint32_t i = 0; i < slots; ++i) {
+            auto &request = combiner.requests[i];
+            if (request.state.load(std::memory_order_acquire) == State::Pending) {
+                appends[count++] = {request.key, request.tid, i};
+            }
+        }
+        std::sort(appends, appends + count, [](const Append &a, const Append &b) {
+            return *a.key < *b.key;
+        });
+        for (uint32_t i = 0; i < count; ++i) {
+            insertInEpoche(*appends[i].key, appends[i].tid, session.getThreadInfo(),
+                           &finger.prepare(*appends[i].key, session, true), true);
+        }
+        if (count > 0) {
+            // only the combiner writes it
+            uint64_t prefix = getAppendPrefix(*appends[count - 1].key);
+            if (prefix > combiner.maxPrefix.load(std::memory_order_relaxed)) {
+                combiner.maxPrefix.store(prefix, std::memory_order_relaxed);
+            }
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            combiner.requests[appends[i].slot].state.store(State::Done, std::memory_order_release);
+        }
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::insertInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo, RestartPath *fingerPath,
+                                            bool append) {
+        assert(k.getKeyLen() >= rootTableLevels);
+        RestartPath ownPath;
+        RestartPath &path = fingerPath != nullptr ? *fingerPath : ownPath;
+        uint32_t restarts = 0;
+        // created once, a compressed leaf may need a cell
+        N *leaf = N::setLeaf(tid, k, epocheInfo);
         restart:
+        if (restarts++ > 0) Backoff::spin(restarts - 1);
         bool needRestart = false;
 
         N *node = nullptr;
-        N *nextNode = root;
+        uint32_t level = 0;
+        N *nextNode = getStartNode(k, level);
         N *parentNode = nullptr;
         uint8_t parentKey, nodeKey = 0;
         uint64_t parentVersion = 0;
-        uint32_t level = 0;
+        // the depth of nextNode, the root is at depth 0
+        uint32_t depth = 0;
+
+        if (auto resumeAt = path.resume()) {
+            node = path[resumeAt - 1].node;
+            parentVersion = path[resumeAt - 1].version;
+            nextNode = path[resumeAt].node;
+            nodeKey = path[resumeAt].nodeKey;
+            level = path[resumeAt].level;
+            depth = resumeAt;
+        }
 
         while (true) {
             parentNode = node;
             parentKey = nodeKey;
             node = nextNode;
-            auto v = node->readLockOrRestart(needRestart);
+            auto v = node->readLockOrRestart<Backoff>(needRestart);
             if (needRestart) goto restart;
+            path.push(node, v, level, parentKey, false);
 
             uint32_t nextLevel = level;
 
@@ -535,10 +1114,10 @@ namespace ART_OLC {
                         goto restart;
                     }
                     // 1) Create new node which will be parent of node, Set common prefix, level to this node
-                    auto newNode = new N4(node->getPrefix(), nextLevel - level);
+                    auto newNode = new(epoche.allocateNode(sizeof(N4), depth, epocheInfo)) N4(node->getPrefix(), nextLevel - level);
 
                     // 2)  add node and (tid, *k) as children
-                    newNode->insert(k[nextLevel], N::setLeaf(tid));
+                    newNode->insert(k[nextLevel], leaf);
                     newNode->insert(nonMatchingKey, node);
 
                     // 3) upgradeToWriteLockOrRestart, update parentNode to point to the new node, unlock
@@ -555,6 +1134,12 @@ namespace ART_OLC {
                 case CheckPrefixPessimisticResult::Match:
                     break;
             }
+            if (node->getType() == NTypes::Bucket) {
+                insertIntoBucket(static_cast<Bucket *>(node), v, parentNode, parentVersion, parentKey, k, level, leaf,
+                                 depth, needRestart, epocheInfo);
+                if (needRestart) goto restart;
+                return;
+            }
             level = nextLevel;
             nodeKey = k[level];
             nextNode = N::getChild(nodeKey, node);
@@ -562,7 +1147,7 @@ namespace ART_OLC {
             if (needRestart) goto restart;
 
             if (nextNode == nullptr) {
-                N::insertAndUnlock(node, v, parentNode, parentVersion, parentKey, nodeKey, N::setLeaf(tid), needRestart, epocheInfo);
+                N::insertAndUnlock(node, v, parentNode, parentVersion, parentKey, nodeKey, leaf, depth, needRestart, epocheInfo);
                 if (needRestart) goto restart;
                 return;
             }
@@ -580,41 +1165,163 @@ namespace ART_OLC {
                 loadKey(N::getLeaf(nextNode), key);
 
                 level++;
+#ifdef ART_LEAF_BUCKETS
+                N *leaves[2] = {leaf, nextNode};
+                Key keys[2] = {k, key};
+                if (key < k) {
+                    std::swap(leaves[0], leaves[1]);
+                    std::swap(keys[0], keys[1]);
+                }
+                N::change(node, k[level - 1], Bucket::build(leaves, keys, 2, level, depth + 1, epocheInfo));
+                node->writeUnlock();
+                return;
+#endif
                 uint32_t prefixLength = 0;
                 while (key[level + prefixLength] == k[level + prefixLength]) {
                     prefixLength++;
                 }
 
-                auto n4 = new N4(&k[level], prefixLength);
-                n4->insert(k[level + prefixLength], N::setLeaf(tid));
-                n4->insert(key[level + prefixLength], nextNode);
-                N::change(node, k[level - 1], n4);
+                uint32_t capacity = 4;
+                if (append) {
+                    // the closest node to the left, if it branches on the same key byte
+                    for (uint32_t keyByte = k[level - 1]; keyByte > 0; --keyByte) {
+                        N *sibling = N::getChild(keyByte - 1, node);
+                        if (sibling != nullptr) {
+                            if (!N::isLeaf(sibling) && sibling->getPrefixLength() == prefixLength) {
+                                // the count of a full N256 wraps around
+                                capacity = sibling->getType() == NTypes::N256 ? 256 : sibling->getCount();
+                            }
+                            break;
+                        }
+                    }
+                }
+                auto newNode = N::createSized(capacity, &k[level], prefixLength, k[level + prefixLength], leaf,
+                                              key[level + prefixLength], nextNode, depth + 1, epocheInfo);
+                N::change(node, k[level - 1], newNode);
                 node->writeUnlock();
                 return;
             }
             level++;
+            depth++;
             parentVersion = v;
         }
     }
 
-    void Tree::remove(const Key &k, TID tid, ThreadInfo &threadInfo) {
+    template<typename Backoff>
+    void BasicTree<Backoff>::insertIntoBucket(Bucket *b, uint64_t v, N *parentNode, uint64_t parentVersion,
+                                              uint8_t parentKey, const Key &k, uint32_t level, N *leaf,
+                                              uint32_t depth, bool &needRestart, ThreadInfo &epocheInfo) {
+        uint32_t bucketLevel = level + b->getPrefixLength();
+        if (!b->isFull()) {
+            parentNode->readUnlockOrRestart(parentVersion, needRestart);
+            if (needRestart) return;
+
+            b->upgradeToWriteLockOrRestart(v, needRestart);
+            if (needRestart) return;
+
+            b->insert(b->getInsertPosition(k, bucketLevel, loadKey), Bucket::getPartialKey(k, bucketLevel), leaf);
+            b->writeUnlock();
+            return;
+        }
+        parentNode->upgradeToWriteLockOrRestart(parentVersion, needRestart);
+        if (needRestart) return;
+
+        b->upgradeToWriteLockOrRestart(v, needRestart);
+        if (needRestart) {
+            parentNode->writeUnlock();
+            return;
+        }
+        N::change(parentNode, parentKey, b->grow(b->getInsertPosition(k, bucketLevel, loadKey), leaf, k, level,
+                                                 loadKey, depth, epocheInfo));
+        parentNode->writeUnlock();
+
+        b->writeUnlockObsolete();
+        epoche.markNodeForDeletion(b, N::getNodeSize(b), epocheInfo);
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::removeFromBucket(Bucket *b, uint64_t v, N *parentNode, uint64_t parentVersion,
+                                              uint8_t parentKey, const Key &k, uint32_t level, TID tid,
+                                              uint32_t depth, bool &needRestart, ThreadInfo &threadInfo) {
+        uint32_t pos = b->find(Bucket::getPartialKey(k, level), tid);
+        if (pos >= b->getCount()) {
+            b->readUnlockOrRestart(v, needRestart);
+            return;
+        }
+        N *leaf = b->getLeaves()[pos];
+        if (b->getCount() == 2 || b->isUnderfull()) {
+            parentNode->upgradeToWriteLockOrRestart(parentVersion, needRestart);
+            if (needRestart) return;
+
+            b->upgradeToWriteLockOrRestart(v, needRestart);
+            if (needRestart) {
+                parentNode->writeUnlock();
+                return;
+            }
+            // the last leaf takes the place of the bucket
+            N::change(parentNode, parentKey, b->getCount() == 2 ? static_cast<N *>(b->getLeaves()[1 - pos])
+                                                                : b->shrink(pos, depth, threadInfo));
+            parentNode->writeUnlock();
+
+            b->writeUnlockObsolete();
+            epoche.markNodeForDeletion(b, N::getNodeSize(b), threadInfo);
+        } else {
+            parentNode->readUnlockOrRestart(parentVersion, needRestart);
+            if (needRestart) return;
+
+            b->upgradeToWriteLockOrRestart(v, needRestart);
+            if (needRestart) return;
+
+            b->remove(pos);
+            b->writeUnlock();
+        }
+        N::retireLeaf(leaf, threadInfo);
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::remove(const Key &k, TID tid, ThreadInfo &threadInfo) {
         EpocheGuard epocheGuard(threadInfo);
+        removeInEpoche(k, tid, threadInfo);
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::remove(const Key &k, TID tid, EpocheSession &session) {
+        removeInEpoche(k, tid, session.getThreadInfo());
+    }
+
+    template<typename Backoff>
+    void BasicTree<Backoff>::removeInEpoche(const Key &k, TID tid, ThreadInfo &threadInfo) {
+        RestartPath path;
+        uint32_t restarts = 0;
         restart:
+        if (restarts++ > 0) Backoff::spin(restarts - 1);
         bool needRestart = false;
 
         N *node = nullptr;
-        N *nextNode = root;
+        uint32_t level = 0;
+        N *nextNode = getStartNode(k, level);
         N *parentNode = nullptr;
         uint8_t parentKey, nodeKey = 0;
         uint64_t parentVersion = 0;
-        uint32_t level = 0;
+        // the depth of nextNode, the root is at depth 0
+        uint32_t depth = 0;
+
+        if (auto resumeAt = path.resume()) {
+            node = path[resumeAt - 1].node;
+            parentVersion = path[resumeAt - 1].version;
+            nextNode = path[resumeAt].node;
+            nodeKey = path[resumeAt].nodeKey;
+            level = path[resumeAt].level;
+            depth = resumeAt;
+        }
 
         while (true) {
             parentNode = node;
             parentKey = nodeKey;
             node = nextNode;
-            auto v = node->readLockOrRestart(needRestart);
+            auto v = node->readLockOrRestart<Backoff>(needRestart);
             if (needRestart) goto restart;
+            path.push(node, v, level, parentKey, false);
 
             switch (checkPrefix(node, k, level)) { // increases level
                 case CheckPrefixResult::NoMatch:
@@ -624,6 +1331,12 @@ namespace ART_OLC {
                 case CheckPrefixResult::OptimisticMatch:
                     // fallthrough
                 case CheckPrefixResult::Match: {
+                    if (node->getType() == NTypes::Bucket) {
+                        removeFromBucket(static_cast<Bucket *>(node), v, parentNode, parentVersion, parentKey, k, level,
+                                         tid, depth, needRestart, threadInfo);
+                        if (needRestart) goto restart;
+                        return;
+                    }
                     nodeKey = k[level];
                     nextNode = N::getChild(nodeKey, node);
 
@@ -659,9 +1372,9 @@ namespace ART_OLC {
 
                                 parentNode->writeUnlock();
                                 node->writeUnlockObsolete();
-                                this->epoche.markNodeForDeletion(node, threadInfo);
+                                this->epoche.markNodeForDeletion(node, N::getNodeSize(node), threadInfo);
                             } else {
-                                secondNodeN->writeLockOrRestart(needRestart);
+                                secondNodeN->writeLockOrRestart<Backoff>(needRestart);
                                 if (needRestart) {
                                     node->writeUnlock();
                                     parentNode->writeUnlock();
@@ -676,31 +1389,35 @@ namespace ART_OLC {
                                 secondNodeN->writeUnlock();
 
                                 node->writeUnlockObsolete();
-                                this->epoche.markNodeForDeletion(node, threadInfo);
+                                this->epoche.markNodeForDeletion(node, N::getNodeSize(node), threadInfo);
                             }
                         } else {
-                            N::removeAndUnlock(node, v, k[level], parentNode, parentVersion, parentKey, needRestart, threadInfo);
+                            N::removeAndUnlock(node, v, k[level], parentNode, parentVersion, parentKey, depth, shrinkPolicy,
+                                              needRestart, threadInfo);
                             if (needRestart) goto restart;
                         }
+                        N::retireLeaf(nextNode, threadInfo);
                         return;
                     }
                     level++;
+                    depth++;
                     parentVersion = v;
                 }
             }
         }
     }
 
-    inline typename Tree::CheckPrefixResult Tree::checkPrefix(N *n, const Key &k, uint32_t &level) {
+    template<typename Backoff>
+    inline typename BasicTree<Backoff>::CheckPrefixResult BasicTree<Backoff>::checkPrefix(N *n, const Key &k, uint32_t &level) {
         if (n->hasPrefix()) {
             if (k.getKeyLen() <= level + n->getPrefixLength()) {
                 return CheckPrefixResult::NoMatch;
             }
-            for (uint32_t i = 0; i < std::min(n->getPrefixLength(), maxStoredPrefixLength); ++i) {
-                if (n->getPrefix()[i] != k[level]) {
-                    return CheckPrefixResult::NoMatch;
-                }
-                ++level;
+            uint32_t stored = std::min(n->getPrefixLength(), maxStoredPrefixLength);
+            uint32_t matching = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, stored);
+            level += matching;
+            if (matching != stored) {
+                return CheckPrefixResult::NoMatch;
             }
             if (n->getPrefixLength() > maxStoredPrefixLength) {
                 level = level + (n->getPrefixLength() - maxStoredPrefixLength);
@@ -710,52 +1427,69 @@ namespace ART_OLC {
         return CheckPrefixResult::Match;
     }
 
-    typename Tree::CheckPrefixPessimisticResult Tree::checkPrefixPessimistic(N *n, const Key &k, uint32_t &level,
+    template<typename Backoff>
+    typename BasicTree<Backoff>::CheckPrefixPessimisticResult BasicTree<Backoff>::checkPrefixPessimistic(N *n, const Key &k, uint32_t &level,
                                                                         uint8_t &nonMatchingKey,
                                                                         Prefix &nonMatchingPrefix,
                                                                         LoadKeyFunction loadKey, bool &needRestart) {
         if (n->hasPrefix()) {
             uint32_t prevLevel = level;
+            uint32_t length = n->getPrefixLength();
+            uint32_t stored = std::min(length, maxStoredPrefixLength);
+            // a key that ends within the prefix does not match it
+            uint32_t available = k.getKeyLen() > level ? std::min(k.getKeyLen() - level, length) : 0;
             Key kt;
-            for (uint32_t i = 0; i < n->getPrefixLength(); ++i) {
-                if (i == maxStoredPrefixLength) {
-                    auto anyTID = N::getAnyChildTid(n, needRestart);
-                    if (needRestart) return CheckPrefixPessimisticResult::Match;
-                    loadKey(anyTID, kt);
-                }
-                uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
-                if (curKey != k[level]) {
-                    nonMatchingKey = curKey;
-                    if (n->getPrefixLength() > maxStoredPrefixLength) {
-                        if (i < maxStoredPrefixLength) {
-                            auto anyTID = N::getAnyChildTid(n, needRestart);
-                            if (needRestart) return CheckPrefixPessimisticResult::Match;
-                            loadKey(anyTID, kt);
-                        }
-                        memcpy(nonMatchingPrefix, &kt[0] + level + 1, std::min((n->getPrefixLength() - (level - prevLevel) - 1),
-                                                                           maxStoredPrefixLength));
-                    } else {
-                        memcpy(nonMatchingPrefix, n->getPrefix() + i + 1, n->getPrefixLength() - i - 1);
+            uint32_t i = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, std::min(stored, available));
+            if (i == stored && length > maxStoredPrefixLength) {
+                auto anyTID = N::getAnyChildTid(n, needRestart);
+                if (needRestart) return CheckPrefixPessimisticResult::Match;
+                loadKey(anyTID, kt);
+                i += NodeSearch::mismatch(kt.getData() + level + i, k.getData() + level + i, available - i);
+            }
+            level += i;
+            if (i < length) {
+                nonMatchingKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
+                if (length > maxStoredPrefixLength) {
+                    if (i < maxStoredPrefixLength) {
+                        auto anyTID = N::getAnyChildTid(n, needRestart);
+                        if (needRestart) return CheckPrefixPessimisticResult::Match;
+                        loadKey(anyTID, kt);
                     }
-                    return CheckPrefixPessimisticResult::NoMatch;
+                    memcpy(nonMatchingPrefix, &kt[0] + level + 1, std::min((length - (level - prevLevel) - 1),
+                                                                       maxStoredPrefixLength));
+                } else {
+                    memcpy(nonMatchingPrefix, n->getPrefix() + i + 1, length - i - 1);
                 }
-                ++level;
+                return CheckPrefixPessimisticResult::NoMatch;
             }
         }
         return CheckPrefixPessimisticResult::Match;
     }
 
-    typename Tree::PCCompareResults Tree::checkPrefixCompare(const N *n, const Key &k, uint8_t fillKey, uint32_t &level,
+    template<typename Backoff>
+    typename BasicTree<Backoff>::PCCompareResults BasicTree<Backoff>::checkPrefixCompare(const N *n, const Key &k, uint8_t fillKey, uint32_t &level,
                                                         LoadKeyFunction loadKey, bool &needRestart) {
         if (n->hasPrefix()) {
+            uint32_t length = n->getPrefixLength();
+            uint32_t stored = std::min(length, maxStoredPrefixLength);
+            // the prefix bytes behind the end of k are compared with fillKey
+            uint32_t available = k.getKeyLen() > level ? std::min(k.getKeyLen() - level, length) : 0;
             Key kt;
-            for (uint32_t i = 0; i < n->getPrefixLength(); ++i) {
-                if (i == maxStoredPrefixLength) {
+            uint32_t i = NodeSearch::mismatch(n->getPrefix(), k.getData() + level, std::min(stored, available));
+            if (i == stored && length > maxStoredPrefixLength) {
+                auto anyTID = N::getAnyChildTid(n, needRestart);
+                if (needRestart) return PCCompareResults::Equal;
+                loadKey(anyTID, kt);
+                i += NodeSearch::mismatch(kt.getData() + level + i, k.getData() + level + i, available - i);
+            }
+            level += i;
+            for (; i < length; ++i) {
+                if (i == maxStoredPrefixLength && kt.getKeyLen() == 0) {
                     auto anyTID = N::getAnyChildTid(n, needRestart);
                     if (needRestart) return PCCompareResults::Equal;
                     loadKey(anyTID, kt);
                 }
-                uint8_t kLevel = (k.getKeyLen() > level) ? k[level] : fillKey;
+                uint8_t kLevel = i < available ? k[level] : fillKey;
 
                 uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : n->getPrefix()[i];
                 if (curKey < kLevel) {
@@ -769,7 +1503,8 @@ namespace ART_OLC {
         return PCCompareResults::Equal;
     }
 
-    typename Tree::PCEqualsResults Tree::checkPrefixEquals(const N *n, uint32_t &level, const Key &start, const Key &end,
+    template<typename Backoff>
+    typename BasicTree<Backoff>::PCEqualsResults BasicTree<Backoff>::checkPrefixEquals(const N *n, uint32_t &level, const Key &start, const Key &end,
                                                       LoadKeyFunction loadKey, bool &needRestart) {
         if (n->hasPrefix()) {
             Key kt;
@@ -793,4 +1528,9 @@ namespace ART_OLC {
         }
         return PCEqualsResults::BothMatch;
     }
+
+    template class BasicTree<NoBackoff>;
+    template class BasicTree<PauseSpin>;
+    template class BasicTree<ExponentialBackoff>;
+    template class BasicTree<SpinThenYield>;
 }
@@ -4,25 +4,243 @@
 
 #ifndef ART_OPTIMISTICLOCK_COUPLING_N_H
 #define ART_OPTIMISTICLOCK_COUPLING_N_H
+#include <functional>
 #include "N.h"
+#include "../TreeStats.h"
 
 using namespace ART;
 
 namespace ART_OLC {
 
-    class Tree {
+    enum class RootTable : uint8_t {
+        // the root is an N256 like the nodes below
+        None,
+        // a slot for each value of the first key byte
+        OneByte,
+        // a slot for each value of the first two key bytes, keys need at least two bytes
+        TwoBytes
+    };
+
+    /**
+     * Backoff selects how operations wait for locked nodes and restarts, see Backoff.h
+     */
+    template<typename Backoff>
+    class BasicTree {
     public:
         using LoadKeyFunction = void (*)(TID tid, Key &key);
 
+        class Finger;
+
     private:
+        // nullptr with a root table
         N *const root;
 
+        RootSlot *const rootSlots;
+
+        // the key bytes the root table addresses, 0 without one
+        const uint32_t rootTableLevels;
+
+        const ShrinkPolicy shrinkPolicy;
+
+        /**
+         * the slot of the first rootTableLevels bytes of k, fill stands for the bytes behind its end
+         */
+        uint32_t getRootSlot(const Key &k, uint8_t fill) const;
+
+        /**
+         * the node a descent for k starts at, the root or the slot of k, and the level of its child key
+         */
+        N *getStartNode(const Key &k, uint32_t &level) const;
+
         TID checkKey(const TID tid, const Key &k) const;
 
         LoadKeyFunction loadKey;
 
         Epoche epoche{256};
 
+        class RestartPath;
+
+        /**
+         * resumes at the path of a finger if one is given
+         */
+        TID lookupInEpoche(const Key &k, RestartPath *fingerPath = nullptr) const;
+
+        /**
+         * looks k up in the bucket read at version v, level is the first key byte after its prefix
+         */
+        TID lookupBucket(const Bucket *b, uint64_t v, const Key &k, uint32_t level, bool optimisticPrefixMatch,
+                         bool &needRestart) const;
+
+        /**
+         * copies the leaves of a bucket between the bounds that are given, the start inclusive and the end exclusive
+         */
+        void copyBucket(const N *node, uint32_t level, const Key *start, const Key *end,
+                        const std::function<void(const N *)> &copy, const TID &toContinue) const;
+
+        using FindBound = std::function<void(N *, uint8_t, uint32_t, const N *, uint64_t)>;
+
+        /**
+         * the part of a range over several slots of the root table, findEnd is empty for a range without end
+         */
+        void scanRootSlots(uint32_t startSlot, uint32_t endSlot, const FindBound &findStart, const FindBound &findEnd,
+                           const std::function<void(const N *)> &copy, const TID &toContinue) const;
+
+        bool lookupRangeInEpoche(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                 std::size_t resultLen, std::size_t &resultCount) const;
+
+        /**
+         * scans in chunks and refreshes the session between them while the epoche is over its budget
+         */
+        bool lookupRangeBounded(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultLen, std::size_t &resultCount, EpocheSession &session) const;
+
+        bool lookupRangeInEpoche(const Key &start, TID result[], std::size_t resultLen, std::size_t &resultCount) const;
+
+        /**
+         * an append sizes the node it starts after a leaf like its left neighbour, which the keys before filled
+         */
+        void insertInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo, RestartPath *fingerPath = nullptr,
+                            bool append = false);
+
+        void removeInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo);
+
+        /**
+         * replaces the child of parent at key by a smaller type if it fits and compacts the subtree below it, the
+         * epoche has to be entered
+         */
+        std::size_t compactChild(N *parent, uint8_t key, uint32_t depth, ThreadInfo &threadInfo);
+
+        /**
+         * The bucket was read at version v and its prefix matched from level on. A full bucket is replaced
+         * by one of twice the capacity or split into inner nodes, an underfull one by one of half the capacity.
+         */
+        void insertIntoBucket(Bucket *b, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t parentKey,
+                              const Key &k, uint32_t level, N *leaf, uint32_t depth, bool &needRestart,
+                              ThreadInfo &epocheInfo);
+
+        void removeFromBucket(Bucket *b, uint64_t v, N *parentNode, uint64_t parentVersion, uint8_t parentKey,
+                              const Key &k, uint32_t level, TID tid, uint32_t depth, bool &needRestart,
+                              ThreadInfo &threadInfo);
+
+        /**
+         * Nodes visited by the current descent together with the versions they were read at.
+         * On a restart the descent resumes at the deepest node whose parent is still unchanged
+         * instead of repeating the whole traversal from the root. Building with ART_RESTART_FROM_ROOT
+         * records nothing and every restart begins at the root again, e.g. to compare both.
+         */
+        class RestartPath {
+        public:
+            struct Entry {
+                N *node;
+                uint64_t version;
+                uint32_t level;
+                uint8_t nodeKey;
+                bool optimisticPrefixMatch;
+            };
+
+        private:
+            static constexpr uint32_t maxDepth = 32;
+
+            Entry entries[maxDepth];
+            uint32_t depth = 0;
+
+        public:
+            void push(N *node, uint64_t version, uint32_t level, uint8_t nodeKey, bool optimisticPrefixMatch);
+
+            /**
+             * drops every entry that can no longer be trusted and returns the number of entries
+             * left, the next descent starts at entry resume()
+             */
+            uint32_t resume();
+
+            /**
+             * keeps the entries of the nodes a key passes as well if it shares the first matchingBytes bytes with
+             * the key of the path, for a pessimistic descent only those below no optimistic prefix match
+             */
+            void truncate(uint32_t matchingBytes, bool pessimistic);
+
+            void clear();
+
+            const Entry &operator[](uint32_t i) const;
+        };
+
+        /**
+         * Flat combining of the appends at the right end of the tree. A thread publishes its insert in the slot of
+         * its finger and the first thread to take the lock inserts everything published so far in key order along
+         * its own finger, so the nodes at the right end are written by one thread at a time instead of all threads
+         * restarting on their locks.
+         */
+        class AppendCombiner {
+        public:
+            enum class State : uint8_t {
+                Free,
+                Claimed,
+                Pending,
+                Done
+            };
+
+            struct alignas(64) Request {
+                std::atomic<State> state{State::Free};
+                const Key *key;
+                TID tid;
+            };
+
+            static constexpr uint32_t maxSlots = 64;
+
+            Request requests[maxSlots];
+            // the slots handed out to fingers, more fingers share slots
+            std::atomic<uint32_t> usedSlots{0};
+            std::atomic<bool> locked{false};
+            // the first 8 bytes of the largest key a combiner inserted
+            std::atomic<uint64_t> maxPrefix{0};
+        };
+
+        AppendCombiner combiner;
+
+        // inserts of a finger in a row whose keys did not decrease before they count as appends
+        static constexpr uint32_t appendRun = 8;
+
+        /**
+         * the first 8 bytes of k as a number, shorter keys are padded with zeros
+         */
+        static uint64_t getAppendPrefix(const Key &k);
+
+        /**
+         * inserts right away if the combiner is free and publishes the insert otherwise, false if the slot of the
+         * finger is taken by another finger, the insert is up to the caller then
+         */
+        bool insertCombined(const Key &k, TID tid, EpocheSession &session, Finger &finger);
+
+        /**
+         * inserts the published appends with the lock of the combiner
+         */
+        void combineAppends(EpocheSession &session, Finger &finger);
+
+    public:
+        /**
+         * The path of the last lookup or insert of one thread inside one EpocheSession. The next operation given
+         * the finger resumes its descent at the deepest node of the path the new key passes as well whose parent
+         * did not change since, like a restart, so sequential and clustered keys skip most of the descent. The
+         * finger starts from scratch in a new or refreshed session, the nodes of the path may be gone then.
+         *
+         * After a run of inserts with ascending keys the finger switches to append mode: new nodes are sized like
+         * their left neighbours and keys beyond the largest appended so far go through the AppendCombiner. A
+         * finger belongs to one thread and one tree.
+         */
+        class Finger {
+            friend class BasicTree;
+
+            RestartPath path;
+            Key lastKey;
+            uint64_t sessionId = 0;
+            // inserts in a row whose first 8 key bytes did not decrease, up to appendRun
+            uint32_t ascending = 0;
+            uint64_t lastPrefix = 0;
+            uint32_t slot = AppendCombiner::maxSlots;
+
+            RestartPath &prepare(const Key &k, const EpocheSession &session, bool pessimistic);
+        };
+
     public:
         enum class CheckPrefixResult : uint8_t {
             Match,
@@ -58,16 +276,52 @@ namespace ART_OLC {
 
     public:
 
-        Tree(LoadKeyFunction loadKey);
+        /**
+         * With a root table the top one or two levels are a fixed array of slots that is never replaced. It
+         * removes a level for each key byte it addresses beyond the first and spreads the locks of the
+         * children at the top over many cache lines. The shrink policy decides when removes replace nodes by
+         * a smaller type, see ShrinkPolicy.
+         */
+        BasicTree(LoadKeyFunction loadKey, ReclamationMode reclamationMode = ReclamationMode::Inline,
+                  NodeAllocator nodeAllocator = NodeAllocator::Heap, RootTable rootTable = RootTable::None,
+                  ShrinkPolicy shrinkPolicy = ShrinkPolicy::Eager);
 
-        Tree(const Tree &) = delete;
+        BasicTree(const BasicTree &) = delete;
 
-        Tree(Tree &&t) : root(t.root), loadKey(t.loadKey) { }
+        // the nodes can live in the arena of the Epoche, which stays with this tree, and the destructor frees
+        // the root table
+        BasicTree(BasicTree &&) = delete;
 
-        ~Tree();
+        ~BasicTree();
 
         ThreadInfo getThreadInfo();
 
+        /**
+         * e.g. to monitor or bound the memory waiting for reclamation
+         */
+        const Epoche &getEpoche() const;
+
+        Epoche &getEpoche();
+
+        /**
+         * bytes of the nodes in the tree, waiting for reclamation and kept for reuse, per node size, summed
+         * from per-thread counters without walking the tree
+         */
+        MemoryUsage memoryUsage() const;
+
+        /**
+         * structural statistics collected by a parallel traversal, the tree must not be modified meanwhile
+         */
+        TreeStats collectStats(unsigned threads = std::thread::hardware_concurrency()) const;
+
+        /**
+         * Replaces the inner nodes whose children fit into a smaller type by the thresholds of eager shrinking,
+         * e.g. from a background thread with ShrinkPolicy::Lazy. Runs alongside the other operations, skips
+         * the nodes that are locked meanwhile and enters the epoche once per child of the root so that it does
+         * not hold back reclamation for the whole pass. Returns the number of nodes replaced.
+         */
+        std::size_t compact(ThreadInfo &threadInfo);
+
         TID lookup(const Key &k, ThreadInfo &threadEpocheInfo) const;
 
         bool lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[], std::size_t resultLen,
@@ -78,6 +332,32 @@ namespace ART_OLC {
         void insert(const Key &k, TID tid, ThreadInfo &epocheInfo);
 
         void remove(const Key &k, TID tid, ThreadInfo &epocheInfo);
+
+        /*
+         * The following overloads run inside an EpocheSession instead of entering and leaving the epoche
+         * for every single operation.
+         */
+
+        TID lookup(const Key &k, EpocheSession &session) const;
+
+        bool lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[], std::size_t resultLen,
+                         std::size_t &resultCount, EpocheSession &session) const;
+
+        bool lookupRange(const Key &start, TID result[], std::size_t resultLen, std::size_t &resultCount, EpocheSession &session) const;
+
+        void insert(const Key &k, TID tid, EpocheSession &session);
+
+        /**
+         * The finger overloads start at the path of the last operation with the finger, see Finger.
+         */
+
+        TID lookup(const Key &k, EpocheSession &session, Finger &finger) const;
+
+        void insert(const Key &k, TID tid, EpocheSession &session, Finger &finger);
+
+        void remove(const Key &k, TID tid, EpocheSession &session);
     };
+
+    using Tree = BasicTree<NoBackoff>;
 }
 #endif //ART_OPTIMISTICLOCK_COUPLING_N_H
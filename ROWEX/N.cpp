@@ -4,6 +4,7 @@
 #include "N.h"
 #include "N4.cpp"
 #include "N16.cpp"
+#include "N32.cpp"
 #include "N48.cpp"
 #include "N256.cpp"
 
@@ -13,11 +14,11 @@ namespace ART_ROWEX {
     }
 
     uint64_t N::convertTypeToVersion(NTypes type) {
-        return (static_cast<uint64_t>(type) << 62);
+        return (static_cast<uint64_t>(type) << 61);
     }
 
     NTypes N::getType() const {
-        return static_cast<NTypes>(typeVersionLockObsolete.load(std::memory_order_relaxed) >> 62);
+        return static_cast<NTypes>(typeVersionLockObsolete.load(std::memory_order_relaxed) >> 61);
     }
 
     uint32_t N::getLevel() const {
@@ -65,6 +66,10 @@ namespace ART_ROWEX {
                 auto n = static_cast<const N16 *>(node);
                 return n->getAnyChild();
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                return n->getAnyChild();
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 return n->getAnyChild();
@@ -90,6 +95,11 @@ namespace ART_ROWEX {
                 n->change(key, val);
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->change(key, val);
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 n->change(key, val);
@@ -106,18 +116,19 @@ namespace ART_ROWEX {
     }
 
     template<typename curN, typename biggerN>
-    void N::insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, ThreadInfo &threadInfo, bool &needRestart) {
+    void N::insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart) {
         if (n->insert(key, val)) {
             n->writeUnlock();
             return;
         }
-        auto nBig = new biggerN(n->getLevel(), n->getPrefi());
+        auto nBig = new(threadInfo.getEpoche().allocateNode(sizeof(biggerN), depth, threadInfo))
+                biggerN(n->getLevel(), n->getPrefi());
         n->copyTo(nBig);
         nBig->insert(key, val);
 
         parentNode->writeLockOrRestart(needRestart);
         if (needRestart) {
-            delete nBig;
+            threadInfo.getEpoche().freeNode(nBig, sizeof(biggerN), threadInfo);
             n->writeUnlock();
             return;
         }
@@ -126,18 +137,18 @@ namespace ART_ROWEX {
         parentNode->writeUnlock();
 
         n->writeUnlockObsolete();
-        threadInfo.getEpoche().markNodeForDeletion(n, threadInfo);
+        threadInfo.getEpoche().markNodeForDeletion(n, sizeof(*n), threadInfo);
     }
 
     template<typename curN>
-    void N::insertCompact(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, ThreadInfo &threadInfo, bool &needRestart) {
-        auto nNew = new curN(n->getLevel(), n->getPrefi());
+    void N::insertCompact(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart) {
+        auto nNew = new(threadInfo.getEpoche().allocateNode(sizeof(curN), depth, threadInfo)) curN(n->getLevel(), n->getPrefi());
         n->copyTo(nNew);
         nNew->insert(key, val);
 
         parentNode->writeLockOrRestart(needRestart);
         if (needRestart) {
-            delete nNew;
+            threadInfo.getEpoche().freeNode(nNew, sizeof(curN), threadInfo);
             n->writeUnlock();
             return;
         }
@@ -146,36 +157,45 @@ namespace ART_ROWEX {
         parentNode->writeUnlock();
 
         n->writeUnlockObsolete();
-        threadInfo.getEpoche().markNodeForDeletion(n, threadInfo);
+        threadInfo.getEpoche().markNodeForDeletion(n, sizeof(*n), threadInfo);
     }
 
-    void N::insertAndUnlock(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val, ThreadInfo &threadInfo, bool &needRestart) {
+    void N::insertAndUnlock(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
                 if (n->compactCount == 4 && n->count <= 3) {
-                    insertCompact<N4>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                    insertCompact<N4>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                     break;
                 }
-                insertGrow<N4, N16>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                insertGrow<N4, N16>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                 break;
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
                 if (n->compactCount == 16 && n->count <= 14) {
-                    insertCompact<N16>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                    insertCompact<N16>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                     break;
                 }
-                insertGrow<N16, N48>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                insertGrow<N16, N32>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
+                break;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                if (n->compactCount == 32 && n->count <= 30) {
+                    insertCompact<N32>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
+                    break;
+                }
+                insertGrow<N32, N48>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                 break;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 if (n->compactCount == 48 && n->count != 48) {
-                    insertCompact<N48>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                    insertCompact<N48>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                     break;
                 }
-                insertGrow<N48, N256>(n, parentNode, keyParent, key, val, threadInfo, needRestart);
+                insertGrow<N48, N256>(n, parentNode, keyParent, key, val, depth, threadInfo, needRestart);
                 break;
             }
             case NTypes::N256: {
@@ -197,6 +217,10 @@ namespace ART_ROWEX {
                 auto n = static_cast<N16 *>(node);
                 return n->getChild(k);
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                return n->getChild(k);
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 return n->getChild(k);
@@ -225,6 +249,11 @@ namespace ART_ROWEX {
                 n->deleteChildren();
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->deleteChildren();
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
                 n->deleteChildren();
@@ -241,17 +270,18 @@ namespace ART_ROWEX {
     }
 
     template<typename curN, typename smallerN>
-    void N::removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, ThreadInfo &threadInfo, bool &needRestart) {
+    void N::removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart) {
         if (n->remove(key, parentNode == nullptr)) {
             n->writeUnlock();
             return;
         }
 
-        auto nSmall = new smallerN(n->getLevel(), n->getPrefi());
+        auto nSmall = new(threadInfo.getEpoche().allocateNode(sizeof(smallerN), depth, threadInfo))
+                smallerN(n->getLevel(), n->getPrefi());
 
         parentNode->writeLockOrRestart(needRestart);
         if (needRestart) {
-            delete nSmall;
+            threadInfo.getEpoche().freeNode(nSmall, sizeof(smallerN), threadInfo);
             n->writeUnlock();
             return;
         }
@@ -262,10 +292,10 @@ namespace ART_ROWEX {
 
         parentNode->writeUnlock();
         n->writeUnlockObsolete();
-        threadInfo.getEpoche().markNodeForDeletion(n, threadInfo);
+        threadInfo.getEpoche().markNodeForDeletion(n, sizeof(*n), threadInfo);
     }
 
-    void N::removeAndUnlock(N *node, uint8_t key, N *parentNode, uint8_t keyParent, ThreadInfo &threadInfo, bool &needRestart) {
+    void N::removeAndUnlock(N *node, uint8_t key, N *parentNode, uint8_t keyParent, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart) {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
@@ -275,17 +305,22 @@ namespace ART_ROWEX {
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                removeAndShrink<N16, N4>(n, parentNode, keyParent, key, threadInfo, needRestart);
+                removeAndShrink<N16, N4>(n, parentNode, keyParent, key, depth, threadInfo, needRestart);
+                break;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                removeAndShrink<N32, N16>(n, parentNode, keyParent, key, depth, threadInfo, needRestart);
                 break;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                removeAndShrink<N48, N16>(n, parentNode, keyParent, key, threadInfo, needRestart);
+                removeAndShrink<N48, N32>(n, parentNode, keyParent, key, depth, threadInfo, needRestart);
                 break;
             }
             case NTypes::N256: {
                 auto n = static_cast<N256 *>(node);
-                removeAndShrink<N256, N48>(n, parentNode, keyParent, key, threadInfo, needRestart);
+                removeAndShrink<N256, N48>(n, parentNode, keyParent, key, depth, threadInfo, needRestart);
                 break;
             }
         }
@@ -349,12 +384,36 @@ namespace ART_ROWEX {
         return (reinterpret_cast<uint64_t>(n) & (static_cast<uint64_t>(1) << 63)) == (static_cast<uint64_t>(1) << 63);
     }
 
-    N *N::setLeaf(TID tid) {
-        return reinterpret_cast<N *>(tid | (static_cast<uint64_t>(1) << 63));
+    N *N::setLeaf(TID tid, const Key &k) {
+        uint64_t value = tid;
+#ifdef ART_LEAF_FINGERPRINTS
+        assert(tid < (static_cast<uint64_t>(1) << fingerprintShift));
+        value |= static_cast<uint64_t>(k.getFingerprint()) << fingerprintShift;
+#else
+        (void) k;
+#endif
+        return reinterpret_cast<N *>(value | (static_cast<uint64_t>(1) << 63));
     }
 
     TID N::getLeaf(const N *n) {
+#ifdef ART_LEAF_FINGERPRINTS
+        return (reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << fingerprintShift) - 1));
+#else
         return (reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << 63) - 1));
+#endif
+    }
+
+    bool N::matchesFingerprint(const N *leaf, const Key &k) {
+#ifdef ART_LEAF_FINGERPRINTS
+        uint64_t value = reinterpret_cast<uint64_t>(leaf);
+        uint8_t fingerprint = static_cast<uint8_t>(value >> fingerprintShift);
+        // leaves without a fingerprint have to be checked
+        return fingerprint == 0 || fingerprint == k.getFingerprint();
+#else
+        (void) leaf;
+        (void) k;
+        return true;
+#endif
     }
 
     std::tuple<N *, uint8_t> N::getSecondChild(N *node, const uint8_t key) {
@@ -370,6 +429,22 @@ namespace ART_ROWEX {
         }
     }
 
+    std::size_t N::getNodeSize(const N *node) {
+        switch (node->getType()) {
+            case NTypes::N4:
+                return sizeof(N4);
+            case NTypes::N16:
+                return sizeof(N16);
+            case NTypes::N32:
+                return sizeof(N32);
+            case NTypes::N48:
+                return sizeof(N48);
+            case NTypes::N256:
+                return sizeof(N256);
+        }
+        return sizeof(N);
+    }
+
     void N::deleteNode(N *node) {
         if (N::isLeaf(node)) {
             return;
@@ -377,26 +452,37 @@ namespace ART_ROWEX {
         switch (node->getType()) {
             case NTypes::N4: {
                 auto n = static_cast<N4 *>(node);
-                delete n;
+                n->~N4();
+                freeNodeMemory(n, sizeof(N4));
                 return;
             }
             case NTypes::N16: {
                 auto n = static_cast<N16 *>(node);
-                delete n;
+                n->~N16();
+                freeNodeMemory(n, sizeof(N16));
+                return;
+            }
+            case NTypes::N32: {
+                auto n = static_cast<N32 *>(node);
+                n->~N32();
+                freeNodeMemory(n, sizeof(N32));
                 return;
             }
             case NTypes::N48: {
                 auto n = static_cast<N48 *>(node);
-                delete n;
+                n->~N48();
+                freeNodeMemory(n, sizeof(N48));
                 return;
             }
             case NTypes::N256: {
                 auto n = static_cast<N256 *>(node);
-                delete n;
+                n->~N256();
+                freeNodeMemory(n, sizeof(N256));
                 return;
             }
         }
-        delete node;
+        assert(false);
+        __builtin_unreachable();
     }
 
     TID N::getAnyChildTid(const N *n) {
@@ -426,6 +512,11 @@ namespace ART_ROWEX {
                 n->getChildren(start, end, children, childrenCount);
                 return;
             }
+            case NTypes::N32: {
+                auto n = static_cast<const N32 *>(node);
+                n->getChildren(start, end, children, childrenCount);
+                return;
+            }
             case NTypes::N48: {
                 auto n = static_cast<const N48 *>(node);
                 n->getChildren(start, end, children, childrenCount);
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "../Key.h"
 #include "../Epoche.h"
+#include "../NodeSearch.h"
 
 using TID = uint64_t;
 
@@ -26,11 +27,18 @@ namespace ART_ROWEX {
     enum class NTypes : uint8_t {
         N4 = 0,
         N16 = 1,
-        N48 = 2,
-        N256 = 3
+        N32 = 2,
+        N48 = 3,
+        N256 = 4
     };
 
     static constexpr uint32_t maxStoredPrefixLength = 4;
+
+#ifdef ART_LEAF_FINGERPRINTS
+    // the 8 bits below the leaf bit hold the fingerprint of the key, TIDs have to fit into the bits below
+    static constexpr uint32_t fingerprintShift = 55;
+#endif
+
     struct Prefix {
         uint32_t prefixCount = 0;
         uint8_t prefix[maxStoredPrefixLength];
@@ -52,7 +60,7 @@ namespace ART_ROWEX {
 
         N(N &&) = delete;
 
-        //2b type 60b version 1b lock 1b obsolete
+        //3b type 59b version 1b lock 1b obsolete
         std::atomic<uint64_t> typeVersionLockObsolete{0b100};
         // version 1, unlocked, not obsolete
         std::atomic<Prefix> prefix;
@@ -102,11 +110,11 @@ namespace ART_ROWEX {
         static N *getChild(const uint8_t k, N *node);
 
         static void insertAndUnlock(N *node, N *parentNode, uint8_t keyParent, uint8_t key, N *val,
-                                    ThreadInfo &threadInfo, bool &needRestart);
+                                    uint32_t depth, ThreadInfo &threadInfo, bool &needRestart);
 
         static void change(N *node, uint8_t key, N *val);
 
-        static void removeAndUnlock(N *node, uint8_t key, N *parentNode, uint8_t keyParent, ThreadInfo &threadInfo, bool &needRestart);
+        static void removeAndUnlock(N *node, uint8_t key, N *parentNode, uint8_t keyParent, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart);
 
         Prefix getPrefi() const;
 
@@ -118,7 +126,13 @@ namespace ART_ROWEX {
 
         static bool isLeaf(const N *n);
 
-        static N *setLeaf(TID tid);
+        static N *setLeaf(TID tid, const Key &k);
+
+        /**
+         * false if the fingerprint stored with the leaf rules out that it belongs to k, always true without
+         * ART_LEAF_FINGERPRINTS
+         */
+        static bool matchesFingerprint(const N *leaf, const Key &k);
 
         static N *getAnyChild(const N *n);
 
@@ -128,16 +142,18 @@ namespace ART_ROWEX {
 
         static void deleteNode(N *node);
 
+        static std::size_t getNodeSize(const N *node);
+
         static std::tuple<N *, uint8_t> getSecondChild(N *node, const uint8_t k);
 
         template<typename curN, typename biggerN>
-        static void insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, ThreadInfo &threadInfo, bool &needRestart);
+        static void insertGrow(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart);
 
         template<typename curN>
-        static void insertCompact(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, ThreadInfo &threadInfo, bool &needRestart);
+        static void insertCompact(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, N *val, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart);
 
         template<typename curN, typename smallerN>
-        static void removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, ThreadInfo &threadInfo, bool &needRestart);
+        static void removeAndShrink(curN *n, N *parentNode, uint8_t keyParent, uint8_t key, uint32_t depth, ThreadInfo &threadInfo, bool &needRestart);
 
         static void getChildren(const N *node, uint8_t start, uint8_t end, std::tuple<uint8_t, N *> children[],
                                 uint32_t &childrenCount);
@@ -240,6 +256,53 @@ namespace ART_ROWEX {
                          uint32_t &childrenCount) const;
     };
 
+    class N32 : public N {
+    public:
+        std::atomic<uint8_t> keys[32];
+        std::atomic<N *> children[32];
+
+        static uint8_t flipSign(uint8_t keyByte) {
+            return keyByte ^ 128;
+        }
+
+        // the first compactCount keys
+        uint32_t usedMask() const {
+            return static_cast<uint32_t>((static_cast<uint64_t>(1) << compactCount) - 1);
+        }
+
+        std::atomic<N *> *getChildPos(const uint8_t k);
+
+    public:
+        N32(uint32_t level, const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N32, level, prefix,
+                                                                              prefixLength) {
+            memset(keys, 0, sizeof(keys));
+            memset(children, 0, sizeof(children));
+        }
+
+        N32(uint32_t level, const Prefix &prefi) : N(NTypes::N32, level, prefi) {
+            memset(keys, 0, sizeof(keys));
+            memset(children, 0, sizeof(children));
+        }
+
+        bool insert(uint8_t key, N *n);
+
+        template<class NODE>
+        void copyTo(NODE *n) const;
+
+        void change(uint8_t key, N *val);
+
+        N *getChild(const uint8_t k) const;
+
+        bool remove(uint8_t k, bool force);
+
+        N *getAnyChild() const;
+
+        void deleteChildren();
+
+        void getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                         uint32_t &childrenCount) const;
+    };
+
     class N48 : public N {
         std::atomic<uint8_t> childIndex[256];
         std::atomic<N *> children[48];
@@ -278,6 +341,8 @@ namespace ART_ROWEX {
 
     class N256 : public N {
         std::atomic<N *> children[256];
+        // bit i set if children[i] is not null, set after and cleared before the child
+        std::atomic<uint64_t> bitmap[4]{};
 
     public:
         N256(uint32_t level, const uint8_t *prefix, uint32_t prefixLength) : N(NTypes::N256, level, prefix,
@@ -1,7 +1,6 @@
 #include <assert.h>
 #include <algorithm>
 #include "N.h"
-#include <emmintrin.h> // x86 SSE intrinsics
 
 namespace ART_ROWEX {
 
@@ -33,9 +32,8 @@ namespace ART_ROWEX {
     }
 
     std::atomic<N *> *N16::getChildPos(const uint8_t k) {
-        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(flipSign(k)),
-                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
-        unsigned bitfield = _mm_movemask_epi8(cmp) & ((1 << compactCount) - 1);
+        unsigned bitfield = NodeSearch::equalMask16(reinterpret_cast<const uint8_t *>(keys), flipSign(k)) &
+                            ((1 << compactCount) - 1);
         while (bitfield) {
             uint8_t pos = ctz(bitfield);
 
@@ -48,9 +46,7 @@ namespace ART_ROWEX {
     }
 
     N *N16::getChild(const uint8_t k) const {
-        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(flipSign(k)),
-                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
-        unsigned bitfield = _mm_movemask_epi8(cmp) & ((1 << 16) - 1);
+        unsigned bitfield = NodeSearch::equalMask16(reinterpret_cast<const uint8_t *>(keys), flipSign(k));
         while (bitfield) {
             uint8_t pos = ctz(bitfield);
 
@@ -101,8 +97,12 @@ namespace ART_ROWEX {
     void N16::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                           uint32_t &childrenCount) const {
         childrenCount = 0;
-        for (int i = 0; i < compactCount; ++i) {
+        unsigned bitfield = NodeSearch::rangeMask16(reinterpret_cast<const uint8_t *>(this->keys), flipSign(start),
+                                                    flipSign(end)) & ((1 << compactCount) - 1);
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned i = ctz(bitfield);
             uint8_t key = flipSign(this->keys[i]);
+            // the keys may have changed since the scan
             if (key >= start && key <= end) {
                 N *child = this->children[i].load();
                 if (child != nullptr) {
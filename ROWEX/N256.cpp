@@ -5,28 +5,32 @@
 namespace ART_ROWEX {
 
     void N256::deleteChildren() {
-        for (uint64_t i = 0; i < 256; ++i) {
-            if (children[i] != nullptr) {
-                N::deleteChildren(children[i]);
-                N::deleteNode(children[i]);
-            }
-        }
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this](unsigned i) {
+            N::deleteChildren(children[i]);
+            N::deleteNode(children[i]);
+            return true;
+        });
     }
 
     bool N256::insert(uint8_t key, N *val) {
         children[key].store(val, std::memory_order_release);
+        // writers hold the node lock, readers only need to see the bit after the child
+        std::atomic<uint64_t> &word = bitmap[key / 64];
+        word.store(word.load(std::memory_order_relaxed) | static_cast<uint64_t>(1) << (key % 64),
+                   std::memory_order_release);
         count++;
         return true;
     }
 
     template<class NODE>
     void N256::copyTo(NODE *n) const {
-        for (int i = 0; i < 256; ++i) {
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, n](unsigned i) {
             N *child = children[i].load();
             if (child != nullptr) {
                 n->insert(i, child);
             }
-        }
+            return true;
+        });
     }
 
     void N256::change(uint8_t key, N *n) {
@@ -41,6 +45,9 @@ namespace ART_ROWEX {
         if (count == 37 && !force) {
             return false;
         }
+        std::atomic<uint64_t> &word = bitmap[k / 64];
+        word.store(word.load(std::memory_order_relaxed) & ~(static_cast<uint64_t>(1) << (k % 64)),
+                   std::memory_order_release);
         children[k].store(nullptr, std::memory_order_release);
         count--;
         return true;
@@ -48,28 +55,28 @@ namespace ART_ROWEX {
 
     N *N256::getAnyChild() const {
         N *anyChild = nullptr;
-        for (uint64_t i = 0; i < 256; ++i) {
+        NodeSearch::forEachBit256(bitmap, 0, 255, [this, &anyChild](unsigned i) {
             N *child = children[i].load();
-            if (child != nullptr) {
-                if (N::isLeaf(child)) {
-                    return child;
-                } else {
-                    anyChild = child;
-                }
+            if (child == nullptr) {
+                return true;
             }
-        }
+            anyChild = child;
+            return !N::isLeaf(child);
+        });
         return anyChild;
     }
 
     void N256::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                            uint32_t &childrenCount) const {
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
+        // the bitmap may have been read before a child was removed
+        NodeSearch::forEachBit256(bitmap, start, end, [this, children, &childrenCount](unsigned i) {
             N *child = this->children[i].load();
             if (child != nullptr) {
                 children[childrenCount] = std::make_tuple(i, child);
                 childrenCount++;
             }
-        }
+            return true;
+        });
     }
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include <assert.h>
+#include <algorithm>
+#include "N.h"
+
+namespace ART_ROWEX {
+
+    bool N32::insert(uint8_t key, N *n) {
+        if (compactCount == 32) {
+            return false;
+        }
+        keys[compactCount].store(flipSign(key), std::memory_order_release);
+        children[compactCount].store(n, std::memory_order_release);
+        compactCount++;
+        count++;
+        return true;
+    }
+
+    template<class NODE>
+    void N32::copyTo(NODE *n) const {
+        for (unsigned i = 0; i < compactCount; i++) {
+            N *child = children[i].load();
+            if (child != nullptr) {
+                n->insert(flipSign(keys[i]), child);
+            }
+        }
+    }
+
+    void N32::change(uint8_t key, N *val) {
+        auto childPos = getChildPos(key);
+        assert(childPos != nullptr);
+        return childPos->store(val, std::memory_order_release);
+    }
+
+    std::atomic<N *> *N32::getChildPos(const uint8_t k) {
+        uint32_t bitfield = NodeSearch::equalMask32(reinterpret_cast<const uint8_t *>(keys), flipSign(k)) &
+                            usedMask();
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = __builtin_ctz(bitfield);
+            if (children[pos].load() != nullptr) {
+                return &children[pos];
+            }
+        }
+        return nullptr;
+    }
+
+    N *N32::getChild(const uint8_t k) const {
+        uint32_t bitfield = NodeSearch::equalMask32(reinterpret_cast<const uint8_t *>(keys), flipSign(k));
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned pos = __builtin_ctz(bitfield);
+            N *child = children[pos].load();
+            if (child != nullptr && keys[pos].load() == flipSign(k)) {
+                return child;
+            }
+        }
+        return nullptr;
+    }
+
+    bool N32::remove(uint8_t k, bool force) {
+        if (count == 12 && !force) {
+            return false;
+        }
+        auto leafPlace = getChildPos(k);
+        assert(leafPlace != nullptr);
+        leafPlace->store(nullptr, std::memory_order_release);
+        count--;
+        assert(getChild(k) == nullptr);
+        return true;
+    }
+
+    N *N32::getAnyChild() const {
+        N *anyChild = nullptr;
+        for (int i = 0; i < 32; ++i) {
+            N *child = children[i].load();
+            if (child != nullptr) {
+                if (N::isLeaf(child)) {
+                    return child;
+                }
+                anyChild = child;
+            }
+        }
+        return anyChild;
+    }
+
+    void N32::deleteChildren() {
+        for (std::size_t i = 0; i < compactCount; ++i) {
+            if (children[i].load() != nullptr) {
+                N::deleteChildren(children[i]);
+                N::deleteNode(children[i]);
+            }
+        }
+    }
+
+    void N32::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
+                          uint32_t &childrenCount) const {
+        childrenCount = 0;
+        uint32_t bitfield = NodeSearch::rangeMask32(reinterpret_cast<const uint8_t *>(this->keys), flipSign(start),
+                                                    flipSign(end)) & usedMask();
+        for (; bitfield != 0; bitfield &= bitfield - 1) {
+            unsigned i = __builtin_ctz(bitfield);
+            uint8_t key = flipSign(this->keys[i]);
+            // the keys may have changed since the scan
+            if (key >= start && key <= end) {
+                N *child = this->children[i].load();
+                if (child != nullptr) {
+                    children[childrenCount] = std::make_tuple(key, child);
+                    childrenCount++;
+                }
+            }
+        }
+        std::sort(children, children + childrenCount, [](auto &first, auto &second) {
+            return std::get<0>(first) < std::get<0>(second);
+        });
+    }
+}
@@ -17,10 +17,16 @@ namespace ART_ROWEX {
 
     template<class NODE>
     void N48::copyTo(NODE *n) const {
-        for (unsigned i = 0; i < 256; i++) {
-            uint8_t index = childIndex[i].load();
-            if (index != emptyMarker) {
-                n->insert(i, children[index]);
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        auto indexBytes = reinterpret_cast<const uint8_t *>(childIndex);
+        for (unsigned base = 0; base < 256; base += 64) {
+            for (uint64_t mask = nonEmptyMask(indexBytes + base, emptyMarker); mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
+                // the scan may be stale, the index is read again
+                uint8_t index = childIndex[i].load();
+                if (index != emptyMarker) {
+                    n->insert(i, children[index]);
+                }
             }
         }
     }
@@ -41,7 +47,7 @@ namespace ART_ROWEX {
     }
 
     bool N48::remove(uint8_t k, bool force) {
-        if (count == 12 && !force) {
+        if (count == 24 && !force) {
             return false;
         }
         assert(childIndex[k] != emptyMarker);
@@ -78,13 +84,25 @@ namespace ART_ROWEX {
     void N48::getChildren(uint8_t start, uint8_t end, std::tuple<uint8_t, N *> *&children,
                           uint32_t &childrenCount) const {
         childrenCount = 0;
-        for (unsigned i = start; i <= end; i++) {
-            uint8_t index = this->childIndex[i].load();
-            if (index != emptyMarker) {
-                N *child = this->children[index].load();
-                if (child != nullptr) {
-                    children[childrenCount] = std::make_tuple(i, child);
-                    childrenCount++;
+        NodeSearch::NonEmptyMask nonEmptyMask = NodeSearch::getKernel().nonEmptyMask64;
+        auto indexBytes = reinterpret_cast<const uint8_t *>(this->childIndex);
+        for (unsigned base = start & ~63u; base <= end; base += 64) {
+            uint64_t mask = nonEmptyMask(indexBytes + base, emptyMarker);
+            if (base < start) {
+                mask &= ~0ull << (start - base);
+            }
+            if (end < base + 63) {
+                mask &= ~0ull >> (base + 63 - end);
+            }
+            for (; mask != 0; mask &= mask - 1) {
+                unsigned i = base + __builtin_ctzll(mask);
+                uint8_t index = this->childIndex[i].load();
+                if (index != emptyMarker) {
+                    N *child = this->children[index].load();
+                    if (child != nullptr) {
+                        children[childrenCount] = std::make_tuple(i, child);
+                        childrenCount++;
+                    }
                 }
             }
         }
@@ -7,11 +7,15 @@
 
 namespace ART_ROWEX {
 
-    Tree::Tree(LoadKeyFunction loadKey) : root(new N256(0, {})), loadKey(loadKey) {
+    Tree::Tree(LoadKeyFunction loadKey, ReclamationMode reclamationMode, NodeAllocator nodeAllocator)
+            : root(new(allocateNodeMemory(sizeof(N256))) N256(0, {})), loadKey(loadKey), epoche(256, reclamationMode, nodeAllocator) {
     }
 
     Tree::~Tree() {
-        N::deleteChildren(root);
+        // nodes from the arena are freed with it, only the root comes from the heap
+        if (epoche.getNodeAllocator() == NodeAllocator::Heap) {
+            N::deleteChildren(root);
+        }
         N::deleteNode(root);
     }
 
@@ -19,8 +23,40 @@ namespace ART_ROWEX {
         return ThreadInfo(this->epoche);
     }
 
+    const Epoche &Tree::getEpoche() const {
+        return epoche;
+    }
+
+    Epoche &Tree::getEpoche() {
+        return epoche;
+    }
+
+    MemoryUsage Tree::memoryUsage() const {
+        MemoryUsage usage = epoche.getMemoryUsage();
+        // allocated with the tree, never replaced
+        usage.get(sizeof(N256)).liveBytes += sizeof(N256);
+        return usage;
+    }
+
+    TreeStats Tree::collectStats(unsigned threads) const {
+        return collectTreeStats(root, threads, [](const N *node, uint32_t level, TreeStats &stats,
+                                                  std::tuple<uint8_t, N *> children[], uint32_t &childrenCount) {
+            N::getChildren(node, 0u, 255u, children, childrenCount);
+            stats.addNode(static_cast<unsigned>(node->getType()), N::getNodeSize(node), level, childrenCount,
+                          node->getPrefi().prefixCount, maxStoredPrefixLength);
+        });
+    }
+
     TID Tree::lookup(const Key &k, ThreadInfo &threadEpocheInfo) const {
         EpocheGuardReadonly epocheGuard(threadEpocheInfo);
+        return lookupInEpoche(k);
+    }
+
+    TID Tree::lookup(const Key &k, EpocheSession &) const {
+        return lookupInEpoche(k);
+    }
+
+    TID Tree::lookupInEpoche(const Key &k) const {
         N *node = root;
         uint32_t level = 0;
         bool optimisticPrefixMatch = false;
@@ -44,7 +80,8 @@ namespace ART_ROWEX {
                     if (N::isLeaf(node)) {
                         TID tid = N::getLeaf(node);
                         if (level < k.getKeyLen() - 1 || optimisticPrefixMatch) {
-                            return checkKey(tid, k);
+                            // a mismatching fingerprint saves loading the key
+                            return N::matchesFingerprint(node, k) ? checkKey(tid, k) : 0;
                         } else {
                             return tid;
                         }
@@ -57,6 +94,45 @@ namespace ART_ROWEX {
 
     bool Tree::lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[],
                                 std::size_t resultSize, std::size_t &resultsFound, ThreadInfo &threadEpocheInfo) const {
+        if (epoche.isBounded()) {
+            EpocheSession session(threadEpocheInfo);
+            return lookupRangeBounded(start, end, continueKey, result, resultSize, resultsFound, session);
+        }
+        EpocheGuard epocheGuard(threadEpocheInfo);
+        return lookupRangeInEpoche(start, end, continueKey, result, resultSize, resultsFound);
+    }
+
+    bool Tree::lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound, EpocheSession &session) const {
+        if (epoche.isBounded()) {
+            return lookupRangeBounded(start, end, continueKey, result, resultSize, resultsFound, session);
+        }
+        return lookupRangeInEpoche(start, end, continueKey, result, resultSize, resultsFound);
+    }
+
+    bool Tree::lookupRangeBounded(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound, EpocheSession &session) const {
+        const std::size_t chunkSize = 1024;
+        Key chunkStart = start;
+        resultsFound = 0;
+        while (true) {
+            std::size_t chunkFound = 0;
+            bool more = lookupRangeInEpoche(chunkStart, end, continueKey, result + resultsFound,
+                                            std::min(chunkSize, resultSize - resultsFound), chunkFound);
+            resultsFound += chunkFound;
+            if (!more || resultsFound == resultSize) {
+                return more;
+            }
+            // no node is held between chunks, the next one starts at the first key not copied yet
+            if (epoche.isOverBudget()) {
+                session.refresh();
+            }
+            chunkStart = continueKey;
+        }
+    }
+
+    bool Tree::lookupRangeInEpoche(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultSize, std::size_t &resultsFound) const {
         for (uint32_t i = 0; i < std::min(start.getKeyLen(), end.getKeyLen()); ++i) {
             if (start[i] > end[i]) {
                 resultsFound = 0;
@@ -65,7 +141,6 @@ namespace ART_ROWEX {
                 break;
             }
         }
-        EpocheGuard epocheGuard(threadEpocheInfo);
         TID toContinue = 0;
         bool restart;
         std::function<void(const N *)> copy = [&result, &resultSize, &resultsFound, &toContinue, &copy](const N *node) {
@@ -243,6 +318,14 @@ namespace ART_ROWEX {
 
     void Tree::insert(const Key &k, TID tid, ThreadInfo &epocheInfo) {
         EpocheGuard epocheGuard(epocheInfo);
+        insertInEpoche(k, tid, epocheInfo);
+    }
+
+    void Tree::insert(const Key &k, TID tid, EpocheSession &session) {
+        insertInEpoche(k, tid, session.getThreadInfo());
+    }
+
+    void Tree::insertInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo) {
         restart:
         bool needRestart = false;
 
@@ -251,6 +334,8 @@ namespace ART_ROWEX {
         N *parentNode = nullptr;
         uint8_t parentKey, nodeKey = 0;
         uint32_t level = 0;
+        // the depth of nextNode, the root is at depth 0
+        uint32_t depth = 0;
 
         while (true) {
             parentNode = node;
@@ -274,16 +359,16 @@ namespace ART_ROWEX {
                     // 1) Create new node which will be parent of node, Set common prefix, level to this node
                     Prefix prefi = node->getPrefi();
                     prefi.prefixCount = nextLevel - level;
-                    auto newNode = new N4(nextLevel, prefi);
+                    auto newNode = new(epoche.allocateNode(sizeof(N4), depth, epocheInfo)) N4(nextLevel, prefi);
 
                     // 2)  add node and (tid, *k) as children
-                    newNode->insert(k[nextLevel], N::setLeaf(tid));
+                    newNode->insert(k[nextLevel], N::setLeaf(tid, k));
                     newNode->insert(nonMatchingKey, node);
 
                     // 3) lockVersionOrRestart, update parentNode to point to the new node, unlock
                     parentNode->writeLockOrRestart(needRestart);
                     if (needRestart) {
-                        delete newNode;
+                        epoche.freeNode(newNode, sizeof(N4), epocheInfo);
                         node->writeUnlock();
                         goto restart;
                     }
@@ -309,7 +394,7 @@ namespace ART_ROWEX {
                 node->lockVersionOrRestart(v, needRestart);
                 if (needRestart) goto restart;
 
-                N::insertAndUnlock(node, parentNode, parentKey, nodeKey, N::setLeaf(tid), epocheInfo, needRestart);
+                N::insertAndUnlock(node, parentNode, parentKey, nodeKey, N::setLeaf(tid, k), depth, epocheInfo, needRestart);
                 if (needRestart) goto restart;
                 return;
             }
@@ -327,19 +412,28 @@ namespace ART_ROWEX {
                     prefixLength++;
                 }
 
-                auto n4 = new N4(level + prefixLength, &k[level], prefixLength);
-                n4->insert(k[level + prefixLength], N::setLeaf(tid));
+                auto n4 = new(epoche.allocateNode(sizeof(N4), depth + 1, epocheInfo)) N4(level + prefixLength, &k[level], prefixLength);
+                n4->insert(k[level + prefixLength], N::setLeaf(tid, k));
                 n4->insert(key[level + prefixLength], nextNode);
                 N::change(node, k[level - 1], n4);
                 node->writeUnlock();
                 return;
             }
             level++;
+            depth++;
         }
     }
 
     void Tree::remove(const Key &k, TID tid, ThreadInfo &threadInfo) {
         EpocheGuard epocheGuard(threadInfo);
+        removeInEpoche(k, tid, threadInfo);
+    }
+
+    void Tree::remove(const Key &k, TID tid, EpocheSession &session) {
+        removeInEpoche(k, tid, session.getThreadInfo());
+    }
+
+    void Tree::removeInEpoche(const Key &k, TID tid, ThreadInfo &threadInfo) {
         restart:
         bool needRestart = false;
 
@@ -348,6 +442,8 @@ namespace ART_ROWEX {
         N *parentNode = nullptr;
         uint8_t parentKey, nodeKey = 0;
         uint32_t level = 0;
+        // the depth of nextNode, the root is at depth 0
+        uint32_t depth = 0;
         //bool optimisticPrefixMatch = false;
 
         while (true) {
@@ -400,7 +496,7 @@ namespace ART_ROWEX {
 
                                 parentNode->writeUnlock();
                                 node->writeUnlockObsolete();
-                                this->epoche.markNodeForDeletion(node, threadInfo);
+                                this->epoche.markNodeForDeletion(node, N::getNodeSize(node), threadInfo);
                             } else {
                                 uint64_t vChild = secondNodeN->getVersion();
                                 secondNodeN->lockVersionOrRestart(vChild, needRestart);
@@ -421,16 +517,17 @@ namespace ART_ROWEX {
 
                                 parentNode->writeUnlock();
                                 node->writeUnlockObsolete();
-                                this->epoche.markNodeForDeletion(node, threadInfo);
+                                this->epoche.markNodeForDeletion(node, N::getNodeSize(node), threadInfo);
                                 secondNodeN->writeUnlock();
                             }
                         } else {
-                            N::removeAndUnlock(node, k[level], parentNode, parentKey, threadInfo, needRestart);
+                            N::removeAndUnlock(node, k[level], parentNode, parentKey, depth, threadInfo, needRestart);
                             if (needRestart) goto restart;
                         }
                         return;
                     }
                     level++;
+                    depth++;
                 }
             }
         }
@@ -472,30 +569,37 @@ namespace ART_ROWEX {
         }
         if (p.prefixCount > 0) {
             uint32_t prevLevel = level;
+            uint32_t i = (level + p.prefixCount) - n->getLevel();
+            // prefix byte j is key byte base + j, a key that ends within the prefix does not match it
+            uint32_t base = level - i;
+            uint32_t stored = std::min(p.prefixCount, maxStoredPrefixLength);
+            uint32_t available = k.getKeyLen() > base ? std::min(k.getKeyLen() - base, p.prefixCount) : 0;
             Key kt;
-            for (uint32_t i = ((level + p.prefixCount) - n->getLevel()); i < p.prefixCount; ++i) {
-                if (i == maxStoredPrefixLength) {
-                    loadKey(N::getAnyChildTid(n), kt);
+            // the stored bytes are too few for the vector compare
+            for (; i < std::min(stored, available) && p.prefix[i] == k[base + i]; ++i);
+            if (i >= stored && p.prefixCount > maxStoredPrefixLength) {
+                loadKey(N::getAnyChildTid(n), kt);
+                if (i < available) {
+                    i += NodeSearch::mismatch(kt.getData() + base + i, k.getData() + base + i, available - i);
                 }
-                uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : p.prefix[i];
-                if (curKey != k[level]) {
-                    nonMatchingKey = curKey;
-                    if (p.prefixCount > maxStoredPrefixLength) {
-                        if (i < maxStoredPrefixLength) {
-                            loadKey(N::getAnyChildTid(n), kt);
-                        }
-                        for (uint32_t j = 0; j < std::min((p.prefixCount - (level - prevLevel) - 1),
-                                                          maxStoredPrefixLength); ++j) {
-                            nonMatchingPrefix.prefix[j] = kt[level + j + 1];
-                        }
-                    } else {
-                        for (uint32_t j = 0; j < p.prefixCount - i - 1; ++j) {
-                            nonMatchingPrefix.prefix[j] = p.prefix[i + j + 1];
-                        }
+            }
+            level = base + i;
+            if (i < p.prefixCount) {
+                nonMatchingKey = i >= maxStoredPrefixLength ? kt[level] : p.prefix[i];
+                if (p.prefixCount > maxStoredPrefixLength) {
+                    if (i < maxStoredPrefixLength) {
+                        loadKey(N::getAnyChildTid(n), kt);
+                    }
+                    for (uint32_t j = 0; j < std::min((p.prefixCount - (level - prevLevel) - 1),
+                                                      maxStoredPrefixLength); ++j) {
+                        nonMatchingPrefix.prefix[j] = kt[level + j + 1];
+                    }
+                } else {
+                    for (uint32_t j = 0; j < p.prefixCount - i - 1; ++j) {
+                        nonMatchingPrefix.prefix[j] = p.prefix[i + j + 1];
                     }
-                    return CheckPrefixPessimisticResult::NoMatch;
                 }
-                ++level;
+                return CheckPrefixPessimisticResult::NoMatch;
             }
         }
         return CheckPrefixPessimisticResult::Match;
@@ -508,12 +612,26 @@ namespace ART_ROWEX {
             return PCCompareResults::SkippedLevel;
         }
         if (p.prefixCount > 0) {
+            uint32_t i = (level + p.prefixCount) - n->getLevel();
+            // prefix byte j is key byte base + j, the prefix bytes behind the end of k are compared with 0
+            uint32_t base = level - i;
+            uint32_t stored = std::min(p.prefixCount, maxStoredPrefixLength);
+            uint32_t available = k.getKeyLen() > base ? std::min(k.getKeyLen() - base, p.prefixCount) : 0;
             Key kt;
-            for (uint32_t i = ((level + p.prefixCount) - n->getLevel()); i < p.prefixCount; ++i) {
-                if (i == maxStoredPrefixLength) {
+            // the stored bytes are too few for the vector compare
+            for (; i < std::min(stored, available) && p.prefix[i] == k[base + i]; ++i);
+            if (i >= stored && p.prefixCount > maxStoredPrefixLength) {
+                loadKey(N::getAnyChildTid(n), kt);
+                if (i < available) {
+                    i += NodeSearch::mismatch(kt.getData() + base + i, k.getData() + base + i, available - i);
+                }
+            }
+            level = base + i;
+            for (; i < p.prefixCount; ++i) {
+                if (i == maxStoredPrefixLength && kt.getKeyLen() == 0) {
                     loadKey(N::getAnyChildTid(n), kt);
                 }
-                uint8_t kLevel = (k.getKeyLen() > level) ? k[level] : 0;
+                uint8_t kLevel = i < available ? k[level] : 0;
 
                 uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : p.prefix[i];
                 if (curKey < kLevel) {
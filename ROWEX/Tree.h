@@ -5,6 +5,7 @@
 #ifndef ART_ROWEX_TREE_H
 #define ART_ROWEX_TREE_H
 #include "N.h"
+#include "../TreeStats.h"
 
 using namespace ART;
 
@@ -23,6 +24,21 @@ namespace ART_ROWEX {
 
         Epoche epoche{256};
 
+        TID lookupInEpoche(const Key &k) const;
+
+        bool lookupRangeInEpoche(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                 std::size_t resultLen, std::size_t &resultCount) const;
+
+        /**
+         * scans in chunks and refreshes the session between them while the epoche is over its budget
+         */
+        bool lookupRangeBounded(const Key &start, const Key &end, Key &continueKey, TID result[],
+                                std::size_t resultLen, std::size_t &resultCount, EpocheSession &session) const;
+
+        void insertInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo);
+
+        void removeInEpoche(const Key &k, TID tid, ThreadInfo &epocheInfo);
+
     public:
         enum class CheckPrefixResult : uint8_t {
             Match,
@@ -61,7 +77,8 @@ namespace ART_ROWEX {
 
     public:
 
-        Tree(LoadKeyFunction loadKey);
+        Tree(LoadKeyFunction loadKey, ReclamationMode reclamationMode = ReclamationMode::Inline,
+             NodeAllocator nodeAllocator = NodeAllocator::Heap);
 
         Tree(const Tree &) = delete;
 
@@ -71,6 +88,24 @@ namespace ART_ROWEX {
 
         ThreadInfo getThreadInfo();
 
+        /**
+         * e.g. to monitor or bound the memory waiting for reclamation
+         */
+        const Epoche &getEpoche() const;
+
+        Epoche &getEpoche();
+
+        /**
+         * bytes of the nodes in the tree, waiting for reclamation and kept for reuse, per node size, summed
+         * from per-thread counters without walking the tree
+         */
+        MemoryUsage memoryUsage() const;
+
+        /**
+         * structural statistics collected by a parallel traversal, the tree must not be modified meanwhile
+         */
+        TreeStats collectStats(unsigned threads = std::thread::hardware_concurrency()) const;
+
         TID lookup(const Key &k, ThreadInfo &threadEpocheInfo) const;
 
         bool lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[], std::size_t resultLen,
@@ -79,6 +114,20 @@ namespace ART_ROWEX {
         void insert(const Key &k, TID tid, ThreadInfo &epocheInfo);
 
         void remove(const Key &k, TID tid, ThreadInfo &epocheInfo);
+
+        /*
+         * The following overloads run inside an EpocheSession instead of entering and leaving the epoche
+         * for every single operation.
+         */
+
+        TID lookup(const Key &k, EpocheSession &session) const;
+
+        bool lookupRange(const Key &start, const Key &end, Key &continueKey, TID result[], std::size_t resultLen,
+                         std::size_t &resultCount, EpocheSession &session) const;
+
+        void insert(const Key &k, TID tid, EpocheSession &session);
+
+        void remove(const Key &k, TID tid, EpocheSession &session);
     };
 }
 #endif //ART_ROWEX_TREE_H
@@ -0,0 +1,243 @@
+#ifndef ART_TREESTATS_H
+#define ART_TREESTATS_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <ostream>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ART {
+
+    /**
+     * structural statistics of a tree as reported by collectStats(), node types are indexed by their NTypes value
+     */
+    struct TreeStats {
+        static constexpr unsigned maxNodeTypes = 8;
+
+        std::array<uint64_t, maxNodeTypes> nodes{};
+        std::array<uint64_t, maxNodeTypes> nodeBytes{};
+
+        /**
+         * fanout[level][c] is the number of nodes at this level with c children, the root is at level 0. Nodes
+         * with more than 256 children are counted at 256.
+         */
+        std::vector<std::array<uint64_t, 257>> fanout;
+
+        /**
+         * prefixLengths[l] is the number of nodes with a prefix of l bytes
+         */
+        std::vector<uint64_t> prefixLengths;
+
+        /**
+         * nodes whose prefix is longer than the part stored in the node, checking it requires loading a key
+         */
+        uint64_t truncatedPrefixes = 0;
+
+        /**
+         * leafDepths[d] is the number of leaves below d nodes
+         */
+        std::vector<uint64_t> leafDepths;
+        uint64_t leaves = 0;
+
+        void addNode(unsigned type, std::size_t bytes, uint32_t level, uint32_t childrenCount, uint32_t prefixLength,
+                     uint32_t maxStoredPrefixLength) {
+            nodes[type]++;
+            nodeBytes[type] += bytes;
+            if (fanout.size() <= level) {
+                fanout.resize(level + 1);
+            }
+            fanout[level][std::min(childrenCount, 256u)]++;
+            if (prefixLengths.size() <= prefixLength) {
+                prefixLengths.resize(prefixLength + 1);
+            }
+            prefixLengths[prefixLength]++;
+            if (prefixLength > maxStoredPrefixLength) {
+                truncatedPrefixes++;
+            }
+        }
+
+        void addLeaf(uint32_t depth) {
+            if (leafDepths.size() <= depth) {
+                leafDepths.resize(depth + 1);
+            }
+            leafDepths[depth]++;
+            leaves++;
+        }
+
+        void merge(const TreeStats &other) {
+            for (unsigned t = 0; t < maxNodeTypes; ++t) {
+                nodes[t] += other.nodes[t];
+                nodeBytes[t] += other.nodeBytes[t];
+            }
+            fanout.resize(std::max(fanout.size(), other.fanout.size()));
+            for (std::size_t l = 0; l < other.fanout.size(); ++l) {
+                for (std::size_t c = 0; c < other.fanout[l].size(); ++c) {
+                    fanout[l][c] += other.fanout[l][c];
+                }
+            }
+            prefixLengths.resize(std::max(prefixLengths.size(), other.prefixLengths.size()));
+            for (std::size_t l = 0; l < other.prefixLengths.size(); ++l) {
+                prefixLengths[l] += other.prefixLengths[l];
+            }
+            truncatedPrefixes += other.truncatedPrefixes;
+            leafDepths.resize(std::max(leafDepths.size(), other.leafDepths.size()));
+            for (std::size_t d = 0; d < other.leafDepths.size(); ++d) {
+                leafDepths[d] += other.leafDepths[d];
+            }
+            leaves += other.leaves;
+        }
+
+        uint64_t getNodeCount() const {
+            uint64_t count = 0;
+            for (auto n : nodes) {
+                count += n;
+            }
+            return count;
+        }
+
+        uint64_t getBytes() const {
+            uint64_t bytes = 0;
+            for (auto b : nodeBytes) {
+                bytes += b;
+            }
+            return bytes;
+        }
+
+        double getBytesPerKey() const {
+            return leaves > 0 ? static_cast<double>(getBytes()) / leaves : 0.0;
+        }
+
+        double getTruncatedPrefixShare() const {
+            uint64_t count = getNodeCount();
+            return count > 0 ? static_cast<double>(truncatedPrefixes) / count : 0.0;
+        }
+
+        double getAverageLeafDepth() const {
+            uint64_t totalDepth = 0;
+            for (std::size_t d = 0; d < leafDepths.size(); ++d) {
+                totalDepth += d * leafDepths[d];
+            }
+            return leaves > 0 ? static_cast<double>(totalDepth) / leaves : 0.0;
+        }
+
+        void print(std::ostream &out) const {
+            static const char *typeNames[maxNodeTypes] = {"N4", "N16", "N32", "N48", "N256", "N65536", "Bucket",
+                                                          "RootSlot"};
+            out << "keys " << leaves << ", nodes " << getNodeCount() << ", bytes " << getBytes()
+                << ", bytes per key " << getBytesPerKey() << ", average leaf depth " << getAverageLeafDepth()
+                << ", truncated prefixes " << getTruncatedPrefixShare() << std::endl;
+            for (unsigned t = 0; t < maxNodeTypes; ++t) {
+                if (nodes[t] != 0) {
+                    out << (typeNames[t] != nullptr ? typeNames[t] : "type") << ": " << nodes[t] << " nodes, "
+                        << nodeBytes[t] << " bytes" << std::endl;
+                }
+            }
+            // histograms as value:count, empty buckets left out
+            auto printHistogram = [&out](const uint64_t *counts, std::size_t size) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    if (counts[i] != 0) {
+                        out << " " << i << ":" << counts[i];
+                    }
+                }
+                out << std::endl;
+            };
+            for (std::size_t l = 0; l < fanout.size(); ++l) {
+                out << "fanout level " << l << ":";
+                printHistogram(fanout[l].data(), fanout[l].size());
+            }
+            out << "prefix lengths:";
+            printHistogram(prefixLengths.data(), prefixLengths.size());
+            out << "leaf depths:";
+            printHistogram(leafDepths.data(), leafDepths.size());
+        }
+    };
+
+    /**
+     * Walks the tree with an explicit stack per thread. The top of the tree is expanded level by level until
+     * there are enough subtrees to spread over the threads, they are handed out to the threads one by one.
+     * visit(node, level, stats, children, childrenCount) records an inner node in stats and returns its children,
+     * at most maxChildren. The walk starts at the given subtrees and their levels.
+     */
+    template<std::size_t maxChildren = 256, typename N, typename Visit>
+    TreeStats collectTreeStats(std::vector<std::pair<N *, uint32_t>> subtrees, unsigned threads, Visit visit) {
+        TreeStats stats;
+        if (subtrees.empty()) {
+            return stats;
+        }
+        threads = std::max(1u, threads);
+        std::vector<std::tuple<uint8_t, N *>> children(maxChildren);
+        while (subtrees.size() < threads * 16) {
+            std::vector<std::pair<N *, uint32_t>> next;
+            bool expanded = false;
+            for (auto &subtree : subtrees) {
+                if (N::isLeaf(subtree.first)) {
+                    next.push_back(subtree);
+                    continue;
+                }
+                uint32_t childrenCount = 0;
+                visit(subtree.first, subtree.second, stats, children.data(), childrenCount);
+                for (uint32_t c = 0; c < childrenCount; ++c) {
+                    next.emplace_back(std::get<1>(children[c]), subtree.second + 1);
+                }
+                expanded = true;
+            }
+            subtrees.swap(next);
+            if (!expanded) {
+                break;
+            }
+        }
+
+        threads = std::min<std::size_t>(threads, subtrees.size());
+        std::vector<TreeStats> threadStats(threads);
+        std::atomic<std::size_t> nextSubtree{0};
+        auto work = [&](TreeStats &s) {
+            std::vector<std::pair<N *, uint32_t>> stack;
+            std::vector<std::tuple<uint8_t, N *>> children(maxChildren);
+            for (std::size_t i = nextSubtree++; i < subtrees.size(); i = nextSubtree++) {
+                stack.push_back(subtrees[i]);
+                while (!stack.empty()) {
+                    N *node = stack.back().first;
+                    uint32_t level = stack.back().second;
+                    stack.pop_back();
+                    if (N::isLeaf(node)) {
+                        s.addLeaf(level);
+                        continue;
+                    }
+                    uint32_t childrenCount = 0;
+                    visit(node, level, s, children.data(), childrenCount);
+                    for (uint32_t c = 0; c < childrenCount; ++c) {
+                        stack.emplace_back(std::get<1>(children[c]), level + 1);
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.emplace_back(work, std::ref(threadStats[t]));
+        }
+        work(threadStats[0]);
+        for (auto &w : workers) {
+            w.join();
+        }
+        for (auto &s : threadStats) {
+            stats.merge(s);
+        }
+        return stats;
+    }
+
+    template<std::size_t maxChildren = 256, typename N, typename Visit>
+    TreeStats collectTreeStats(N *root, unsigned threads, Visit visit) {
+        if (root == nullptr) {
+            return TreeStats();
+        }
+        return collectTreeStats<maxChildren>(std::vector<std::pair<N *, uint32_t>>{{root, 0}}, threads, visit);
+    }
+}
+
+#endif //ART_TREESTATS_H
@@ -121,6 +121,25 @@ void multithreaded(char **argv) {
         printf("insert,%ld,%f\n", n, (n * 1.0) / duration.count());
     }
 
+    {
+        // Build the same tree again, consecutive inserts of a range start where the last one ended
+        ART_OLC::Tree fingerTree(loadKey);
+        auto starttime = std::chrono::system_clock::now();
+        tbb::parallel_for(tbb::blocked_range<uint64_t>(0, n), [&](const tbb::blocked_range<uint64_t> &range) {
+            auto t = fingerTree.getThreadInfo();
+            EpocheSession session(t);
+            ART_OLC::Tree::Finger finger;
+            for (uint64_t i = range.begin(); i != range.end(); i++) {
+                Key key;
+                loadKey(keys[i], key);
+                fingerTree.insert(key, keys[i], session, finger);
+            }
+        });
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now() - starttime);
+        printf("insert finger,%ld,%f\n", n, (n * 1.0) / duration.count());
+    }
+
     {
         // Lookup
         auto starttime = std::chrono::system_clock::now();
@@ -0,0 +1,118 @@
+// Lookup throughput and dTLB load misses of the OLC tree with nodes from the heap compared to the huge page
+// arena. Keys are read from a SOSD dataset (a uint64 count followed by the uint64 keys) if a file is given and
+// are random otherwise. The dTLB misses are read with perf_event_open and shown as n/a if it is not permitted.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. arena_lookup.cpp ../OptimisticLockCoupling/Tree.cpp -lpthread
+//
+//     ./a.out n lookups [sosd file]
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+int openDtlbCounter() {
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+void run(const char *name, NodeAllocator nodeAllocator, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    ART_OLC::Tree tree(loadKey, ReclamationMode::Inline, nodeAllocator);
+    auto t = tree.getThreadInfo();
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        tree.insert(key, k, t);
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> order(lookups);
+    for (auto &k : order) {
+        k = keys[rng() % keys.size()];
+    }
+    int counter = openDtlbCounter();
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    auto starttime = std::chrono::system_clock::now();
+    for (auto k : order) {
+        Key key;
+        loadKey(k, key);
+        if (tree.lookup(key, t) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    std::string misses = "n/a";
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(counter, &count, sizeof(count)) == sizeof(count)) {
+            misses = std::to_string(static_cast<double>(count) / lookups);
+        }
+        close(counter);
+    }
+    const NodeArena *arena = tree.getEpoche().getNodeArena();
+    printf("%s,%f,%s,%lu,%lu\n", name, lookups / (duration.count() / 1000000.0) / 1000000.0, misses.c_str(),
+           arena != nullptr ? arena->getMappedBytes() : 0ul, arena != nullptr ? arena->getHugetlbBytes() : 0ul);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 4) {
+        printf("usage: %s n lookups [sosd file]\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    std::vector<uint64_t> keys;
+    if (argc == 4) {
+        std::ifstream in(argv[3], std::ios::binary);
+        uint64_t count = 0;
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        keys.resize(std::min(count, n));
+        in.read(reinterpret_cast<char *>(keys.data()), keys.size() * sizeof(uint64_t));
+        if (!in) {
+            printf("cannot read %s\n", argv[3]);
+            return 1;
+        }
+    } else {
+        std::mt19937_64 rng(1);
+        for (uint64_t i = 0; i < n; i++) {
+            keys.push_back(rng());
+        }
+    }
+    // the leaf bit of the TID and duplicates are left out
+    for (auto &k : keys) {
+        k >>= 1;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    printf("allocator,Mlookups/s,dTLB load misses per lookup,mapped bytes,hugetlb bytes\n");
+    run("heap", NodeAllocator::Heap, keys, lookups);
+    run("arena", NodeAllocator::HugePageArena, keys, lookups);
+    return 0;
+}
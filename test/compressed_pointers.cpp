@@ -0,0 +1,107 @@
+// Bytes per key and lookup throughput of the unsynchronized and the OLC tree, built once with 8 byte child
+// pointers and once with ART_COMPRESSED_POINTERS. Dense TIDs fit into a child reference, sparse TIDs use the
+// full 63 bits and need a cell of 8 bytes per key with compressed pointers, which is added to the node bytes.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. compressed_pointers.cpp ../OptimisticLockCoupling/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//     g++ -O3 -std=c++14 -march=native -DART_COMPRESSED_POINTERS -I.. compressed_pointers.cpp ../OptimisticLockCoupling/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n lookups
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ART/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+uint64_t cellBytes(const std::vector<uint64_t> &keys) {
+    uint64_t bytes = 0;
+#ifdef ART_COMPRESSED_POINTERS
+    for (auto k : keys) {
+        bytes += k >> 31 != 0 ? sizeof(TID) : 0;
+    }
+#else
+    (void) keys;
+#endif
+    return bytes;
+}
+
+template<typename Fn>
+double mlookupsPerSecond(const std::vector<uint64_t> &keys, uint64_t lookups, Fn lookup) {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> order(lookups);
+    for (auto &k : order) {
+        k = keys[rng() % keys.size()];
+    }
+    auto starttime = std::chrono::system_clock::now();
+    for (auto k : order) {
+        Key key;
+        loadKey(k, key);
+        if (lookup(key) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return lookups / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void runUnsynchronized(const char *tids, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    ART_unsynchronized::Tree tree(loadKey);
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        tree.insert(key, k);
+    }
+    TreeStats stats = tree.collectStats(1);
+    double mlookups = mlookupsPerSecond(keys, lookups, [&](const Key &key) { return tree.lookup(key); });
+    printf("unsync,%s,%f,%f\n", tids, static_cast<double>(stats.getBytes() + cellBytes(keys)) / keys.size(),
+           mlookups);
+}
+
+void runOLC(const char *tids, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    ART_OLC::Tree tree(loadKey);
+    auto t = tree.getThreadInfo();
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        tree.insert(key, k, t);
+    }
+    TreeStats stats = tree.collectStats(1);
+    double mlookups = mlookupsPerSecond(keys, lookups, [&](const Key &key) { return tree.lookup(key, t); });
+    printf("olc,%s,%f,%f\n", tids, static_cast<double>(stats.getBytes() + cellBytes(keys)) / keys.size(), mlookups);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n lookups\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    std::vector<uint64_t> dense, sparse;
+    std::mt19937_64 rng(1);
+    for (uint64_t i = 1; i <= n; i++) {
+        dense.push_back(i);
+        // below the leaf bit
+        sparse.push_back(rng() >> 1);
+    }
+
+#ifdef ART_COMPRESSED_POINTERS
+    printf("compressed child references\n");
+#else
+    printf("8 byte child pointers\n");
+#endif
+    printf("tree,tids,bytes per key,Mlookups/s\n");
+    runUnsynchronized("dense", dense, lookups);
+    runUnsynchronized("sparse", sparse, lookups);
+    runOLC("dense", dense, lookups);
+    runOLC("sparse", sparse, lookups);
+    return 0;
+}
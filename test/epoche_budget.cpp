@@ -0,0 +1,101 @@
+// Memory waiting for reclamation while one thread keeps scanning a large range and the others replace keys,
+// without a bound and with a pending budget. The writers work below another child of the root than the
+// scan, the scan never runs into a node they replace.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. epoche_budget.cpp ../OptimisticLockCoupling/Tree.cpp -lpthread
+//
+//     ./a.out n writers seconds budgetBytes
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+// spreads the keys over the tree, the scanned keys are below 2^62, the written ones between 2^62 and the leaf
+// bit, all of them are even
+uint64_t sparse(uint64_t i, bool written) {
+    return ((i * 0x9E3779B97F4A7C15ul) & ((1ul << 62) - 2)) | (written ? 1ul << 62 : 0);
+}
+
+void run(uint64_t n, unsigned writers, double seconds, std::size_t budget) {
+    ART_OLC::Tree tree(loadKey);
+    tree.getEpoche().setPendingBudget(budget);
+    {
+        auto t = tree.getThreadInfo();
+        for (uint64_t i = 1; i <= n; i++) {
+            Key key;
+            loadKey(sparse(i, false), key);
+            tree.insert(key, sparse(i, false), t);
+            loadKey(sparse(i, true), key);
+            tree.insert(key, sparse(i, true), t);
+        }
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> writes{0};
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() {
+        auto t = tree.getThreadInfo();
+        std::vector<TID> result(n);
+        Key start, end, continueKey;
+        loadKey(0, start);
+        loadKey(1ul << 62, end);
+        while (!stop.load()) {
+            std::size_t found;
+            tree.lookupRange(start, end, continueKey, result.data(), result.size(), found, t);
+        }
+    });
+    for (unsigned w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w]() {
+            auto t = tree.getThreadInfo();
+            std::mt19937_64 rng(w);
+            uint64_t done = 0;
+            // every writer inserts and removes again the odd neighbours of the keys congruent to w, each time
+            // a node for both keys is created and retired
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint64_t k = sparse((rng() % (n / writers)) * writers + w + 1, true) | 1;
+                Key key;
+                loadKey(k, key);
+                tree.insert(key, k, t);
+                tree.remove(key, k, t);
+                done += 2;
+            }
+            writes += done;
+        });
+    }
+    std::size_t maxPending = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        maxPending = std::max(maxPending, tree.getEpoche().getPendingBytes());
+    }
+    stop = true;
+    for (auto &t : threads) {
+        t.join();
+    }
+    printf("%lu,%lu,%f\n", budget, maxPending, writes / seconds);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        printf("usage: %s n writers seconds budgetBytes\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned writers = std::atoi(argv[2]);
+    double seconds = std::atof(argv[3]);
+    std::size_t budget = std::atoll(argv[4]);
+
+    printf("budget,max pending bytes,writes/s\n");
+    run(n, writers, seconds, 0);
+    run(n, writers, seconds, budget);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Memory waiting for reclamation when every batch of work runs on new short-lived threads. A thread frees what
+// is safe when its ThreadInfo goes away and hands the rest over to the threads of later batches.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. epoche_orphans.cpp ../OptimisticLockCoupling/Tree.cpp -lpthread
+//
+//     ./a.out keysPerThread threads batches
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s keysPerThread threads batches\n", argv[0]);
+        return 1;
+    }
+    uint64_t keysPerThread = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+    unsigned batches = std::atoi(argv[3]);
+
+    ART_OLC::Tree tree(loadKey);
+    printf("batch,pending bytes in threads,retired bytes\n");
+    for (unsigned b = 0; b < batches; ++b) {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                auto threadInfo = tree.getThreadInfo();
+                uint64_t from = (b * threads + t) * keysPerThread + 1;
+                for (uint64_t i = from; i < from + keysPerThread; ++i) {
+                    Key key;
+                    loadKey(i, key);
+                    tree.insert(key, i, threadInfo);
+                }
+                for (uint64_t i = from; i < from + keysPerThread; ++i) {
+                    Key key;
+                    loadKey(i, key);
+                    tree.remove(key, i, threadInfo);
+                }
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+        auto pending = tree.getEpoche().getPendingBytesPerThread();
+        printf("%u,%lu,%lu\n", b, std::accumulate(pending.begin(), pending.end(), 0ul),
+               tree.getEpoche().getRetiredBytes());
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Cost of the epoche for read-only and 95/5 read/write operations, entering it per operation compared to
+// quiescent-state-based reclamation where every thread announces a quiescent state after each request.
+// Checks first that a thread refreshing its session with a pending budget set still holds back the nodes
+// retired by the others.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. epoche_qsbr.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp -lpthread
+//
+//     ./a.out n threads opsPerThread opsPerRequest
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Tree>
+void run(const char *name, const char *mode, ReclamationMode reclamationMode, unsigned writePercent, uint64_t n,
+         unsigned threads, uint64_t opsPerThread, uint64_t opsPerRequest) {
+    Tree tree(loadKey, reclamationMode);
+    {
+        auto t = tree.getThreadInfo();
+        for (uint64_t i = 1; i <= n; i++) {
+            Key key;
+            loadKey(i, key);
+            tree.insert(key, i, t);
+        }
+    }
+
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w]() {
+            auto t = tree.getThreadInfo();
+            std::mt19937_64 rng(w);
+            // writers insert and remove keys above n, each thread its own
+            uint64_t nextKey = n + 1 + w, inserted = 0;
+            for (uint64_t op = 1; op <= opsPerThread; ++op) {
+                Key key;
+                if (rng() % 100 < writePercent) {
+                    if (inserted < 64) {
+                        loadKey(nextKey + inserted * threads, key);
+                        tree.insert(key, nextKey + inserted * threads, t);
+                        ++inserted;
+                    } else {
+                        loadKey(nextKey, key);
+                        tree.remove(key, nextKey, t);
+                        nextKey += threads;
+                        --inserted;
+                    }
+                } else {
+                    uint64_t k = rng() % n + 1;
+                    loadKey(k, key);
+                    if (tree.lookup(key, t) != k) {
+                        std::cout << "wrong key read: " << k << std::endl;
+                        throw;
+                    }
+                }
+                if (reclamationMode == ReclamationMode::Quiescent && op % opsPerRequest == 0) {
+                    tree.getEpoche().quiescentState(t);
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    printf("%s,%s,%u,%f\n", name, mode, writePercent,
+           threads * opsPerThread / (duration.count() / 1000000.0) / 1000000.0);
+}
+
+// the quiescent state of a session refresh collects garbage and waits for the budget, the session reads nodes
+// afterwards and has to be in the epoche again
+bool checkRefreshUnderBudget() {
+    ART::Epoche epoche(16, ReclamationMode::Quiescent);
+    epoche.setPendingBudget(1);
+    std::atomic<int> step{0};
+    std::size_t heldBack = 0, afterOffline = 0;
+    std::thread reader([&]() {
+        ART::ThreadInfo t(epoche);
+        {
+            ART::EpocheSession session(t);
+            // enough garbage of its own that the refresh collects and runs into the budget
+            for (int i = 0; i < 32; ++i) {
+                epoche.markNodeForDeletion(epoche.allocateNode(64, 0, t), 64, t);
+            }
+            session.refresh();
+            step = 1;
+            while (step.load() != 2) {
+                std::this_thread::yield();
+            }
+        }
+        epoche.goOffline(t);
+        step = 3;
+        while (step.load() != 4) {
+            std::this_thread::yield();
+        }
+    });
+    std::thread writer([&]() {
+        ART::ThreadInfo t(epoche);
+        while (step.load() != 1) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < 32; ++i) {
+            epoche.markNodeForDeletion(epoche.allocateNode(64, 0, t), 64, t);
+        }
+        for (int i = 0; i < 4; ++i) {
+            epoche.quiescentState(t);
+        }
+        heldBack = t.getPendingBytes();
+        step = 2;
+        while (step.load() != 3) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < 32; ++i) {
+            epoche.markNodeForDeletion(epoche.allocateNode(64, 0, t), 64, t);
+        }
+        for (int i = 0; i < 4; ++i) {
+            epoche.quiescentState(t);
+        }
+        afterOffline = t.getPendingBytes();
+        step = 4;
+    });
+    reader.join();
+    writer.join();
+    if (heldBack == 0 || afterOffline != 0) {
+        printf("refresh under budget: %lu bytes held back while the session reads, %lu after it went offline\n",
+               heldBack, afterOffline);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        printf("usage: %s n threads opsPerThread opsPerRequest\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+    uint64_t opsPerThread = std::atoll(argv[3]);
+    uint64_t opsPerRequest = std::atoll(argv[4]);
+    if (!checkRefreshUnderBudget()) {
+        return 1;
+    }
+
+    printf("tree,reclamation,write %%,Mops/s\n");
+    for (unsigned writePercent : {0u, 5u}) {
+        run<ART_OLC::Tree>("olc", "epoche", ReclamationMode::Inline, writePercent, n, threads, opsPerThread,
+                           opsPerRequest);
+        run<ART_OLC::Tree>("olc", "qsbr", ReclamationMode::Quiescent, writePercent, n, threads, opsPerThread,
+                           opsPerRequest);
+        run<ART_ROWEX::Tree>("rowex", "epoche", ReclamationMode::Inline, writePercent, n, threads, opsPerThread,
+                             opsPerRequest);
+        run<ART_ROWEX::Tree>("rowex", "qsbr", ReclamationMode::Quiescent, writePercent, n, threads, opsPerThread,
+                             opsPerRequest);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Latency distribution of inserts and removes with nodes freed inline by the workers compared to a background
+// reclaimer thread. Removes retire nodes, inserts after them reuse the freed memory.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. epoche_reclaimer.cpp ../OptimisticLockCoupling/Tree.cpp -lpthread
+//
+//     ./a.out n threads rounds
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+void printPercentiles(const char *mode, const char *operation, std::vector<uint64_t> &latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+    printf("%s,%s,%lu,%lu,%lu,%lu,%lu\n", mode, operation, latencies.size(), percentile(0.5), percentile(0.99),
+           percentile(0.999), latencies.back());
+}
+
+void run(const char *mode, ReclamationMode reclamationMode, uint64_t n, unsigned threads, unsigned rounds) {
+    ART_OLC::Tree tree(loadKey, reclamationMode);
+    std::vector<std::vector<uint64_t>> insertLatencies(threads), removeLatencies(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto threadInfo = tree.getThreadInfo();
+            uint64_t from = t * n / threads + 1, to = (t + 1) * n / threads + 1;
+            for (unsigned r = 0; r < rounds; ++r) {
+                for (uint64_t i = from; i < to; i++) {
+                    Key key;
+                    loadKey(i, key);
+                    auto start = std::chrono::steady_clock::now();
+                    tree.insert(key, i, threadInfo);
+                    insertLatencies[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count());
+                }
+                for (uint64_t i = from; i < to; i++) {
+                    Key key;
+                    loadKey(i, key);
+                    auto start = std::chrono::steady_clock::now();
+                    tree.remove(key, i, threadInfo);
+                    removeLatencies[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count());
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    std::vector<uint64_t> inserts, removes;
+    for (unsigned t = 0; t < threads; ++t) {
+        inserts.insert(inserts.end(), insertLatencies[t].begin(), insertLatencies[t].end());
+        removes.insert(removes.end(), removeLatencies[t].begin(), removeLatencies[t].end());
+    }
+    printPercentiles(mode, "insert", inserts);
+    printPercentiles(mode, "remove", removes);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s n threads rounds\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+    unsigned rounds = std::atoi(argv[3]);
+
+    printf("reclamation,operation,count,p50 ns,p99 ns,p99.9 ns,max ns\n");
+    run("inline", ReclamationMode::Inline, n, threads, rounds);
+    run("background", ReclamationMode::Background, n, threads, rounds);
+    return 0;
+}
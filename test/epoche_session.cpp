@@ -0,0 +1,120 @@
+// Cost of entering the epoche per operation compared to batching many operations into one EpocheSession.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. epoche_session.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp -lpthread
+//
+//     ./a.out n threads refreshInterval
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Fn>
+double measure(uint64_t n, unsigned threads, Fn fn) {
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            fn(t * n / threads + 1, (t + 1) * n / threads + 1);
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return n / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+template<typename Tree>
+void run(const char *name, uint64_t n, unsigned threads, uint64_t refreshInterval, bool useSession) {
+    Tree tree(loadKey);
+    const char *mode = useSession ? "session" : "guard";
+    // each worker works on its own range [from, to)
+    auto insert = [&](uint64_t from, uint64_t to) {
+        auto t = tree.getThreadInfo();
+        if (useSession) {
+            EpocheSession session(t);
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                tree.insert(key, i, session);
+                if (i % refreshInterval == 0) session.refresh();
+            }
+        } else {
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                tree.insert(key, i, t);
+            }
+        }
+    };
+    auto lookup = [&](uint64_t from, uint64_t to) {
+        auto t = tree.getThreadInfo();
+        if (useSession) {
+            EpocheSession session(t);
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                if (tree.lookup(key, session) != i) {
+                    std::cout << "wrong key read: " << i << std::endl;
+                    throw;
+                }
+                if (i % refreshInterval == 0) session.refresh();
+            }
+        } else {
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                if (tree.lookup(key, t) != i) {
+                    std::cout << "wrong key read: " << i << std::endl;
+                    throw;
+                }
+            }
+        }
+    };
+    auto remove = [&](uint64_t from, uint64_t to) {
+        auto t = tree.getThreadInfo();
+        if (useSession) {
+            EpocheSession session(t);
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                tree.remove(key, i, session);
+                if (i % refreshInterval == 0) session.refresh();
+            }
+        } else {
+            for (uint64_t i = from; i < to; i++) {
+                Key key;
+                loadKey(i, key);
+                tree.remove(key, i, t);
+            }
+        }
+    };
+    printf("%s,%s,insert,%lu,%f\n", name, mode, n, measure(n, threads, insert));
+    printf("%s,%s,lookup,%lu,%f\n", name, mode, n, measure(n, threads, lookup));
+    printf("%s,%s,remove,%lu,%f\n", name, mode, n, measure(n, threads, remove));
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s n threads refreshInterval\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+    uint64_t refreshInterval = std::atoll(argv[3]);
+
+    printf("tree,epoche,operation,n,ops/s\n");
+    for (bool useSession : {false, true}) {
+        run<ART_OLC::Tree>("olc", n, threads, refreshInterval, useSession);
+        run<ART_ROWEX::Tree>("rowex", n, threads, refreshInterval, useSession);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Bytes per key, average leaf depth, lookup and range scan throughput of the OLC tree filled by four threads. Built
+// with -DART_LEAF_BUCKETS the leaves below the smallest inner nodes go to sorted buckets of up to 16 leaves, build
+// it once with and once without the flag to compare. The sparse keys are random 55 bit integers, the clustered keys
+// take up to 50 consecutive values per 64.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. [-DART_LEAF_BUCKETS] leaf_buckets.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n lookups
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+std::vector<uint64_t> unique(std::vector<uint64_t> keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+std::vector<uint64_t> generateSparse(uint64_t n) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = (rng() >> 9) | 1;
+    }
+    return unique(keys);
+}
+
+std::vector<uint64_t> generateClustered(uint64_t n) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = (rng() % (n / 4 + 1)) * 64 + rng() % 50 + 1;
+    }
+    return unique(keys);
+}
+
+double perSecond(uint64_t operations, std::chrono::system_clock::time_point starttime) {
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return operations / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void run(const char *name, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    const unsigned threads = 4;
+    std::vector<uint64_t> shuffled = keys;
+    std::mt19937_64 rng(42);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+    ART_OLC::Tree tree(loadKey);
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&tree, &shuffled, t]() {
+            auto threadInfo = tree.getThreadInfo();
+            for (std::size_t i = t; i < shuffled.size(); i += threads) {
+                Key key;
+                loadKey(shuffled[i], key);
+                tree.insert(key, shuffled[i], threadInfo);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    double insertThroughput = perSecond(keys.size(), starttime);
+
+    auto threadInfo = tree.getThreadInfo();
+    std::vector<uint64_t> order(lookups);
+    for (auto &k : order) {
+        k = keys[rng() % keys.size()];
+    }
+    starttime = std::chrono::system_clock::now();
+    for (auto k : order) {
+        Key key;
+        loadKey(k, key);
+        if (tree.lookup(key, threadInfo) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    double lookupThroughput = perSecond(lookups, starttime);
+
+    // scans of 100 keys from random start keys
+    const std::size_t scanLength = 100;
+    TID result[scanLength];
+    uint64_t scanned = 0;
+    starttime = std::chrono::system_clock::now();
+    for (uint64_t i = 0; i < lookups / scanLength; ++i) {
+        Key start;
+        loadKey(order[i], start);
+        std::size_t resultCount = 0;
+        tree.lookupRange(start, result, scanLength, resultCount, threadInfo);
+        scanned += resultCount;
+    }
+    double scanThroughput = perSecond(scanned, starttime);
+
+    auto stats = tree.collectStats(1);
+#ifdef ART_LEAF_BUCKETS
+    const char *buckets = "yes";
+#else
+    const char *buckets = "no";
+#endif
+    printf("%s,%s,%lu,%f,%f,%f,%f,%f\n", name, buckets, stats.nodes[static_cast<unsigned>(ART_OLC::NTypes::Bucket)],
+           stats.getBytesPerKey(), stats.getAverageLeafDepth(), insertThroughput, lookupThroughput, scanThroughput);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n lookups\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    printf("keys,leaf buckets,buckets,bytes per key,average leaf depth,Minserts/s,Mlookups/s,Mscanned keys/s\n");
+    run("sparse", generateSparse(n), lookups);
+    run("clustered", generateClustered(n), lookups);
+    return 0;
+}
@@ -0,0 +1,104 @@
+// loadKey calls per lookup of keys that are not in the tree and of keys that are, and the miss throughput of all
+// three trees. Built with ART_LEAF_FINGERPRINTS the misses only load a key if the fingerprints collide, the
+// ratio of the loadKey calls per miss of both builds is the false positive rate of the fingerprints.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. leaf_fingerprints.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//     g++ -O3 -std=c++14 -march=native -DART_LEAF_FINGERPRINTS -I.. leaf_fingerprints.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n lookups
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+#include "../ART/Tree.h"
+
+uint64_t loadKeyCalls = 0;
+
+void loadKey(TID tid, Key &key) {
+    ++loadKeyCalls;
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Lookup>
+void run(const char *name, const std::vector<uint64_t> &hits, const std::vector<uint64_t> &misses, Lookup lookup) {
+    loadKeyCalls = 0;
+    for (auto k : hits) {
+        Key key;
+        loadKey(k, key);
+        if (lookup(key) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    double hitCalls = static_cast<double>(loadKeyCalls - hits.size()) / hits.size();
+
+    loadKeyCalls = 0;
+    auto starttime = std::chrono::system_clock::now();
+    for (auto k : misses) {
+        Key key;
+        loadKey(k, key);
+        if (lookup(key) != 0) {
+            std::cout << "key found that was not inserted: " << k << std::endl;
+            throw;
+        }
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    // the calls that build the searched keys are not counted
+    double missCalls = static_cast<double>(loadKeyCalls - misses.size()) / misses.size();
+    printf("%s,%f,%f,%f\n", name, hitCalls, missCalls, misses.size() / (duration.count() / 1000000.0) / 1000000.0);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n lookups\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    // TIDs are the keys and stay below 2^55 for the fingerprint
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < n; i++) {
+        keys.push_back(rng() >> 9);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::vector<uint64_t> hits, misses;
+    while (misses.size() < lookups) {
+        uint64_t k = rng() >> 9;
+        if (!std::binary_search(keys.begin(), keys.end(), k)) {
+            misses.push_back(k);
+        }
+        hits.push_back(keys[rng() % keys.size()]);
+    }
+
+    ART_OLC::Tree olc(loadKey);
+    ART_ROWEX::Tree rowex(loadKey);
+    ART_unsynchronized::Tree unsynchronized(loadKey);
+    auto olcInfo = olc.getThreadInfo();
+    auto rowexInfo = rowex.getThreadInfo();
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        olc.insert(key, k, olcInfo);
+        rowex.insert(key, k, rowexInfo);
+        unsynchronized.insert(key, k);
+    }
+
+#ifdef ART_LEAF_FINGERPRINTS
+    printf("leaf fingerprints\n");
+#else
+    printf("no leaf fingerprints\n");
+#endif
+    printf("tree,loadKey per hit,loadKey per miss,Mmisses/s\n");
+    run("olc", hits, misses, [&](const Key &key) { return olc.lookup(key, olcInfo); });
+    run("rowex", hits, misses, [&](const Key &key) { return rowex.lookup(key, rowexInfo); });
+    run("unsync", hits, misses, [&](const Key &key) { return unsynchronized.lookup(key); });
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Bytes reported by the live counters of memoryUsage() compared to walking the tree with collectStats(), while
+// threads insert and remove keys and after they are done, and the time both take.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. memory_usage.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp -lpthread
+//
+//     ./a.out n threads
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Fn>
+long microseconds(Fn fn) {
+    auto starttime = std::chrono::system_clock::now();
+    fn();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime).count();
+}
+
+template<typename Tree>
+void run(const char *name, uint64_t n, unsigned threads) {
+    Tree tree(loadKey);
+    std::atomic<unsigned> running{threads};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto threadInfo = tree.getThreadInfo();
+            // spreads the keys so that removes shrink and free nodes
+            for (uint64_t i = t + 1; i <= n; i += threads) {
+                Key key;
+                loadKey(i * 0x9E3779B97F4A7C15ul >> 1, key);
+                tree.insert(key, i * 0x9E3779B97F4A7C15ul >> 1, threadInfo);
+            }
+            for (uint64_t i = t + 1; i <= n; i += 2 * threads) {
+                Key key;
+                loadKey(i * 0x9E3779B97F4A7C15ul >> 1, key);
+                tree.remove(key, i * 0x9E3779B97F4A7C15ul >> 1, threadInfo);
+            }
+            running--;
+        });
+    }
+    // sampled while the workers run, costs only a pass over the thread slots
+    uint64_t samples = 0, maxLive = 0;
+    long sampling = microseconds([&]() {
+        for (; running.load() > 0; ++samples) {
+            maxLive = std::max(maxLive, tree.memoryUsage().getLiveBytes());
+        }
+    });
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    MemoryUsage usage;
+    TreeStats stats;
+    long counters = microseconds([&]() { usage = tree.memoryUsage(); });
+    long walk = microseconds([&]() { stats = tree.collectStats(threads); });
+    printf("%s,%lu,%lu,%lu,%lu,%lu,%f,%ld\n", name, usage.getLiveBytes(), stats.getBytes(), usage.getPendingBytes(),
+           usage.getCachedBytes(), maxLive, static_cast<double>(sampling) / std::max<uint64_t>(samples, 1), counters);
+    printf("%s,walk took %ldus\n", name, walk);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n threads\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+
+    printf("tree,live bytes,walked bytes,pending bytes,cached bytes,max live bytes while writing,us per sample,us\n");
+    run<ART_OLC::Tree>("olc", n, threads);
+    run<ART_ROWEX::Tree>("rowex", n, threads);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Range scan throughput of the OLC and the ROWEX tree over keys that make sparse N256 nodes, every key byte takes
+// one of fanout values below 128. With the occupancy bitmap a scan step enumerates the children of an N256 from
+// four words instead of testing all 256 slots. Build it at the commit before the bitmap was added to compare.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. n256_bitmap.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n scans scanLength
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+std::vector<uint64_t> generate(uint64_t n, uint64_t fanout) {
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t k = 0;
+        for (uint64_t v = i, b = 0; b < 7; v /= fanout, b++) {
+            k |= (v % fanout * (128 / fanout) + 1) << (8 * b);
+        }
+        keys.push_back(k);
+    }
+    return keys;
+}
+
+template<typename Tree>
+void run(const char *name, uint64_t fanout, const std::vector<uint64_t> &keys, uint64_t scans,
+         std::size_t scanLength) {
+    Tree tree(loadKey);
+    auto t = tree.getThreadInfo();
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        tree.insert(key, k, t);
+    }
+    std::mt19937_64 rng(42);
+    std::vector<TID> result(scanLength);
+    uint64_t found = 0;
+    auto starttime = std::chrono::system_clock::now();
+    for (uint64_t i = 0; i < scans; i++) {
+        Key start, end, continueKey;
+        loadKey(keys[rng() % keys.size()], start);
+        loadKey(~0ull >> 1, end);
+        std::size_t resultsFound = 0;
+        tree.lookupRange(start, end, continueKey, result.data(), scanLength, resultsFound, t);
+        found += resultsFound;
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    printf("%s,%lu,%f,%f\n", name, fanout, scans / (duration.count() / 1000000.0) / 1000000.0,
+           static_cast<double>(found) / scans);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s n scans scanLength\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t scans = std::atoll(argv[2]);
+    std::size_t scanLength = std::atoll(argv[3]);
+
+    printf("tree,fanout,Mscans/s,keys per scan\n");
+    for (uint64_t fanout : {64, 100, 128}) {
+        auto keys = generate(n, fanout);
+        run<ART_OLC::Tree>("olc", fanout, keys, scans, scanLength);
+        run<ART_ROWEX::Tree>("rowex", fanout, keys, scans, scanLength);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Bytes per key, node counts and lookup throughput of the three trees for keys whose nodes mostly have between 17
+// and 40 children, where N32 replaces N48. Build it at the commit before N32 was added to compare. A dataset in
+// the SOSD format (8 byte count, then the 64 bit keys) can be given instead of the generated keys, the keys are
+// shifted right by one bit to stay below the leaf bit.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. n32_nodes.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n lookups [sosd file]
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+#include "../ART/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+// every byte of the key takes one of fanout values
+std::vector<uint64_t> generate(uint64_t n, uint64_t fanout) {
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t k = 0;
+        for (uint64_t v = i, b = 0; b < 7; v /= fanout, b++) {
+            k |= (v % fanout * (128 / fanout) + 1) << (8 * b);
+        }
+        keys.push_back(k);
+    }
+    return keys;
+}
+
+std::vector<uint64_t> readSosd(const char *file, uint64_t n) {
+    std::ifstream in(file, std::ios::binary);
+    uint64_t size = 0;
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    std::vector<uint64_t> keys(std::min(size, n));
+    in.read(reinterpret_cast<char *>(keys.data()), keys.size() * sizeof(uint64_t));
+    for (auto &k : keys) {
+        k = (k >> 1) | 1;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+template<typename Lookup>
+double mlookupsPerSecond(const std::vector<uint64_t> &keys, uint64_t lookups, Lookup lookup) {
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> order(lookups);
+    for (auto &k : order) {
+        k = keys[rng() % keys.size()];
+    }
+    auto starttime = std::chrono::system_clock::now();
+    for (auto k : order) {
+        Key key;
+        loadKey(k, key);
+        if (lookup(key) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return lookups / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void report(const char *tree, const char *keys, const TreeStats &stats, double mlookups) {
+    printf("%s,%s,%f,%f\n", tree, keys, stats.getBytesPerKey(), mlookups);
+    stats.print(std::cout);
+}
+
+void run(const char *name, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    {
+        ART_OLC::Tree tree(loadKey);
+        auto t = tree.getThreadInfo();
+        for (auto k : keys) {
+            Key key;
+            loadKey(k, key);
+            tree.insert(key, k, t);
+        }
+        double mlookups = mlookupsPerSecond(keys, lookups, [&](const Key &key) { return tree.lookup(key, t); });
+        report("olc", name, tree.collectStats(1), mlookups);
+    }
+    {
+        ART_ROWEX::Tree tree(loadKey);
+        auto t = tree.getThreadInfo();
+        for (auto k : keys) {
+            Key key;
+            loadKey(k, key);
+            tree.insert(key, k, t);
+        }
+        double mlookups = mlookupsPerSecond(keys, lookups, [&](const Key &key) { return tree.lookup(key, t); });
+        report("rowex", name, tree.collectStats(1), mlookups);
+    }
+    {
+        ART_unsynchronized::Tree tree(loadKey);
+        for (auto k : keys) {
+            Key key;
+            loadKey(k, key);
+            tree.insert(key, k);
+        }
+        double mlookups = mlookupsPerSecond(keys, lookups, [&](const Key &key) { return tree.lookup(key); });
+        report("unsync", name, tree.collectStats(1), mlookups);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 4) {
+        printf("usage: %s n lookups [sosd file]\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    printf("tree,keys,bytes per key,Mlookups/s\n");
+    if (argc == 4) {
+        run(argv[3], readSosd(argv[3], n), lookups);
+        return 0;
+    }
+    run("fanout 20", generate(n, 20), lookups);
+    run("fanout 28", generate(n, 28), lookups);
+    run("fanout 40", generate(n, 40), lookups);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Nanoseconds per search of the node search kernels: key lookup in N4, key lookup, lower bound and range extraction
+// in N16 and range extraction over the child index of N48 with every kernel the CPU supports. The scalar loops are
+// what the nodes did before. N4 compares the loop with a word-at-a-time and an SSE2 compare of its four keys, N16
+// the inlined SSE2 kernels with AVX2 and AVX-512 kernels called through a pointer chosen at runtime, the way a
+// portable binary would reach them. Build it with and without -march=native to compare the portable binary.
+//
+//     g++ -O3 -std=c++14 -I.. node_search.cpp
+//
+//     ./a.out searches
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../NodeSearch.h"
+
+using namespace ART;
+
+// N16 kernels that are only reached through a pointer, the SSE2 ones are inlined into the nodes
+struct N16Kernel {
+    const char *name;
+    uint32_t (*equalMask)(const uint8_t *keys, uint8_t key);
+    uint32_t (*greaterMask)(const uint8_t *keys, uint8_t key);
+    uint32_t (*rangeMask)(const uint8_t *keys, uint8_t start, uint8_t end);
+};
+
+__attribute__((target("avx2")))
+uint32_t equalMask16Avx2(const uint8_t *keys, uint8_t key) {
+    __m128i cmp = _mm_cmpeq_epi8(_mm_broadcastb_epi8(_mm_cvtsi32_si128(key)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+}
+
+__attribute__((target("avx2")))
+uint32_t greaterMask16Avx2(const uint8_t *keys, uint8_t key) {
+    __m128i cmp = _mm_cmplt_epi8(_mm_broadcastb_epi8(_mm_cvtsi32_si128(key)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+}
+
+__attribute__((target("avx2")))
+uint32_t rangeMask16Avx2(const uint8_t *keys, uint8_t start, uint8_t end) {
+    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+    __m128i outside = _mm_or_si128(_mm_cmplt_epi8(k, _mm_broadcastb_epi8(_mm_cvtsi32_si128(start))),
+                                   _mm_cmpgt_epi8(k, _mm_broadcastb_epi8(_mm_cvtsi32_si128(end))));
+    return static_cast<uint16_t>(~_mm_movemask_epi8(outside));
+}
+
+__attribute__((target("avx512bw,avx512vl")))
+uint32_t equalMask16Avx512(const uint8_t *keys, uint8_t key) {
+    return _mm_cmpeq_epi8_mask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)), _mm_set1_epi8(key));
+}
+
+__attribute__((target("avx512bw,avx512vl")))
+uint32_t greaterMask16Avx512(const uint8_t *keys, uint8_t key) {
+    return _mm_cmpgt_epi8_mask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)), _mm_set1_epi8(key));
+}
+
+__attribute__((target("avx512bw,avx512vl")))
+uint32_t rangeMask16Avx512(const uint8_t *keys, uint8_t start, uint8_t end) {
+    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+    return _mm_mask_cmple_epi8_mask(_mm_cmpge_epi8_mask(k, _mm_set1_epi8(start)), k, _mm_set1_epi8(end));
+}
+
+std::vector<N16Kernel> getWideN16Kernels() {
+    std::vector<N16Kernel> kernels;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", equalMask16Avx2, greaterMask16Avx2, rangeMask16Avx2});
+    }
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl")) {
+        kernels.push_back({"avx512", equalMask16Avx512, greaterMask16Avx512, rangeMask16Avx512});
+    }
+    return kernels;
+}
+
+template<typename Fn>
+void measure(const char *node, const char *operation, const char *kernel, uint64_t searches, Fn fn) {
+    uint64_t sink = 0;
+    auto starttime = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < searches; ++i) {
+        sink += fn(i);
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - starttime);
+    printf("%s,%s,%s,%f,%lu\n", node, operation, kernel, static_cast<double>(duration.count()) / searches, sink);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("usage: %s searches\n", argv[0]);
+        return 1;
+    }
+    uint64_t searches = std::atoll(argv[1]);
+
+    // 1024 nodes of each type with random keys, the searched keys are random as well
+    const unsigned nodes = 1024;
+    std::mt19937_64 rng(1);
+    std::vector<uint8_t> keys4(nodes * 4), counts4(nodes), keys16(nodes * 16), childIndex(nodes * 256),
+            searched(nodes);
+    for (auto &k : keys4) {
+        k = rng();
+    }
+    for (auto &c : counts4) {
+        // an N4 holds 2 to 4 children
+        c = 2 + rng() % 3;
+    }
+    for (auto &k : keys16) {
+        k = rng();
+    }
+    for (unsigned n = 0; n < nodes; ++n) {
+        for (unsigned i = 0; i < 256; ++i) {
+            // about 24 of the 256 keys used
+            childIndex[n * 256 + i] = rng() % 256 < 24 ? rng() % 48 : 48;
+        }
+        searched[n] = rng();
+    }
+
+    printf("node,operation,kernel,ns per search,checksum\n");
+    measure("N4", "find", "scalar", searches, [&](uint64_t i) {
+        const uint8_t *keys = &keys4[(i % nodes) * 4];
+        for (unsigned k = 0; k < counts4[i % nodes]; ++k) {
+            if (keys[k] == searched[i % nodes]) {
+                return k;
+            }
+        }
+        return 4u;
+    });
+    measure("N4", "find", "word", searches, [&](uint64_t i) {
+        uint32_t keys;
+        memcpy(&keys, &keys4[(i % nodes) * 4], sizeof(keys));
+        // a zero byte where the key matches, the lowest one is exact
+        uint32_t x = keys ^ (searched[i % nodes] * 0x01010101u);
+        uint32_t bitfield = (x - 0x01010101u) & ~x & 0x80808080u & (0xFFFFFFFFu >> (32 - 8 * counts4[i % nodes]));
+        return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) / 8 : 4u;
+    });
+    measure("N4", "find", "sse2", searches, [&](uint64_t i) {
+        int32_t keys;
+        memcpy(&keys, &keys4[(i % nodes) * 4], sizeof(keys));
+        __m128i cmp = _mm_cmpeq_epi8(_mm_cvtsi32_si128(keys), _mm_set1_epi8(searched[i % nodes]));
+        uint32_t bitfield = _mm_movemask_epi8(cmp) & ((1u << counts4[i % nodes]) - 1);
+        return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) : 4u;
+    });
+
+    measure("N16", "find", "scalar", searches, [&](uint64_t i) {
+        const uint8_t *keys = &keys16[(i % nodes) * 16];
+        for (unsigned k = 0; k < 16; ++k) {
+            if (keys[k] == searched[i % nodes]) {
+                return k;
+            }
+        }
+        return 16u;
+    });
+    measure("N16", "find", "sse2", searches, [&](uint64_t i) {
+        uint32_t bitfield = NodeSearch::equalMask16(&keys16[(i % nodes) * 16], searched[i % nodes]);
+        return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) : 16u;
+    });
+    measure("N16", "lower bound", "scalar", searches, [&](uint64_t i) {
+        const uint8_t *keys = &keys16[(i % nodes) * 16];
+        unsigned pos = 0;
+        for (; pos < 16 && static_cast<int8_t>(keys[pos]) <= static_cast<int8_t>(searched[i % nodes]); ++pos);
+        return pos;
+    });
+    measure("N16", "lower bound", "sse2", searches, [&](uint64_t i) {
+        uint32_t bitfield = NodeSearch::greaterMask16(&keys16[(i % nodes) * 16], searched[i % nodes]);
+        return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) : 16u;
+    });
+    measure("N16", "range", "scalar", searches, [&](uint64_t i) {
+        const uint8_t *keys = &keys16[(i % nodes) * 16];
+        int8_t start = static_cast<int8_t>(searched[i % nodes]) / 2, end = start + 64;
+        unsigned found = 0;
+        for (unsigned k = 0; k < 16; ++k) {
+            found += static_cast<int8_t>(keys[k]) >= start && static_cast<int8_t>(keys[k]) <= end;
+        }
+        return found;
+    });
+    measure("N16", "range", "sse2", searches, [&](uint64_t i) {
+        int8_t start = static_cast<int8_t>(searched[i % nodes]) / 2, end = start + 64;
+        return static_cast<unsigned>(__builtin_popcount(NodeSearch::rangeMask16(&keys16[(i % nodes) * 16], start, end)));
+    });
+
+    for (auto &kernel : getWideN16Kernels()) {
+        measure("N16", "find", kernel.name, searches, [&](uint64_t i) {
+            uint32_t bitfield = kernel.equalMask(&keys16[(i % nodes) * 16], searched[i % nodes]);
+            return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) : 16u;
+        });
+        measure("N16", "lower bound", kernel.name, searches, [&](uint64_t i) {
+            uint32_t bitfield = kernel.greaterMask(&keys16[(i % nodes) * 16], searched[i % nodes]);
+            return bitfield != 0 ? static_cast<unsigned>(__builtin_ctz(bitfield)) : 16u;
+        });
+        measure("N16", "range", kernel.name, searches, [&](uint64_t i) {
+            int8_t start = static_cast<int8_t>(searched[i % nodes]) / 2, end = start + 64;
+            return static_cast<unsigned>(__builtin_popcount(kernel.rangeMask(&keys16[(i % nodes) * 16], start, end)));
+        });
+    }
+
+    // from the searched key to the end of the node, as a range scan that continues in the next node
+    for (auto &kernel : NodeSearch::getSupportedKernels()) {
+        measure("N48", "range", kernel.name, searches, [&](uint64_t i) {
+            const uint8_t *index = &childIndex[(i % nodes) * 256];
+            unsigned start = searched[i % nodes], found = 0;
+            for (unsigned base = start & ~63u; base < 256; base += 64) {
+                uint64_t mask = kernel.nonEmptyMask64(index + base, 48);
+                if (base < start) {
+                    mask &= ~0ull << (start - base);
+                }
+                found += __builtin_popcountll(mask);
+            }
+            return found;
+        });
+    }
+    std::cout << "nodes use " << NodeSearch::getKernel().name << std::endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Load and 95/5 lookup/write throughput for a growing number of threads pinned round-robin to the NUMA nodes,
+// nodes allocated from the heap compared to one arena per NUMA node with the top levels interleaved. Passing
+// a number of nodes simulates that topology on any machine, it sets ART_NUMA_NODES.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. numa_sweep.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp -lpthread
+//
+//     ./a.out n opsPerThread maxThreads [simulated nodes]
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+// spread over the whole key space, below the leaf bit
+uint64_t keyOf(uint64_t i) {
+    return i * 0x9E3779B97F4A7C15ul >> 1;
+}
+
+template<typename Fn>
+double runThreads(unsigned threads, uint64_t ops, Fn fn) {
+    const NumaTopology &topology = NumaTopology::get();
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            topology.pinThread(t % topology.getNodeCount());
+            fn(t);
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return ops / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+template<typename Tree>
+void run(const char *name, const char *allocator, NodeAllocator nodeAllocator, uint64_t n, unsigned threads,
+         uint64_t opsPerThread) {
+    Tree tree(loadKey, ReclamationMode::Inline, nodeAllocator);
+
+    // every thread inserts its share, the lower levels end up on the node of the thread
+    double load = runThreads(threads, n, [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        for (uint64_t i = t + 1; i <= n; i += threads) {
+            Key key;
+            loadKey(keyOf(i), key);
+            tree.insert(key, keyOf(i), threadInfo);
+        }
+    });
+
+    double mixed = runThreads(threads, threads * opsPerThread, [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        std::mt19937_64 rng(t);
+        // writers insert and remove keys after the first n, each thread its own
+        uint64_t nextKey = n + 1 + t, inserted = 0;
+        for (uint64_t op = 0; op < opsPerThread; ++op) {
+            Key key;
+            if (rng() % 100 < 5) {
+                if (inserted < 64) {
+                    uint64_t k = keyOf(nextKey + inserted * threads);
+                    loadKey(k, key);
+                    tree.insert(key, k, threadInfo);
+                    ++inserted;
+                } else {
+                    loadKey(keyOf(nextKey), key);
+                    tree.remove(key, keyOf(nextKey), threadInfo);
+                    nextKey += threads;
+                    --inserted;
+                }
+            } else {
+                uint64_t k = keyOf(rng() % n + 1);
+                loadKey(k, key);
+                if (tree.lookup(key, threadInfo) != k) {
+                    std::cout << "wrong key read: " << k << std::endl;
+                    throw;
+                }
+            }
+        }
+    });
+
+    const Epoche &epoche = tree.getEpoche();
+    std::size_t placed = epoche.getInterleavedArena() != nullptr ? epoche.getInterleavedArena()->getPlacedBytes() : 0;
+    for (unsigned node = 0; nodeAllocator == NodeAllocator::NumaArena &&
+                            node < epoche.getTopology().getNodeCount(); ++node) {
+        placed += epoche.getNodeArena(node)->getPlacedBytes();
+    }
+    printf("%s,%s,%u,%f,%f,%lu\n", name, allocator, threads, load, mixed, placed);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4 && argc != 5) {
+        printf("usage: %s n opsPerThread maxThreads [simulated nodes]\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t opsPerThread = std::atoll(argv[2]);
+    unsigned maxThreads = std::atoi(argv[3]);
+    if (argc == 5) {
+        setenv("ART_NUMA_NODES", argv[4], 1);
+    }
+
+    const NumaTopology &topology = NumaTopology::get();
+    std::cout << topology.getNodeCount() << (topology.isSimulated() ? " simulated" : "") << " NUMA nodes:";
+    for (unsigned node = 0; node < topology.getNodeCount(); ++node) {
+        std::cout << " " << topology.getNodeId(node) << " (" << topology.getCpus(node).size() << " cpus)";
+    }
+    std::cout << std::endl;
+
+    printf("tree,allocator,threads,load Mops/s,95/5 Mops/s,placed bytes\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        run<ART_OLC::Tree>("olc", "heap", NodeAllocator::Heap, n, threads, opsPerThread);
+        run<ART_OLC::Tree>("olc", "numa", NodeAllocator::NumaArena, n, threads, opsPerThread);
+        run<ART_ROWEX::Tree>("rowex", "heap", NodeAllocator::Heap, n, threads, opsPerThread);
+        run<ART_ROWEX::Tree>("rowex", "numa", NodeAllocator::NumaArena, n, threads, opsPerThread);
+    }
+    return 0;
+}
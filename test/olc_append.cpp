@@ -0,0 +1,86 @@
+// Insert throughput and bytes per key of ART_OLC for time series keys that all threads draw from one counter, so
+// every insert goes to the right end of the tree. Plain session inserts are compared with finger inserts that switch
+// to append mode, pre-size the new nodes at the right end and combine the appends of all threads. The dense keys are
+// consecutive, the sparse keys advance by 1 to 64.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. olc_append.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n maxThreads
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+void run(const char *name, const std::vector<uint64_t> &keys, unsigned threads, bool useFinger) {
+    ART_OLC::Tree tree(loadKey);
+    std::atomic<uint64_t> next{0};
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            auto threadInfo = tree.getThreadInfo();
+            EpocheSession session(threadInfo);
+            ART_OLC::Tree::Finger finger;
+            for (uint64_t i = next++; i < keys.size(); i = next++) {
+                Key key;
+                loadKey(keys[i], key);
+                if (useFinger) {
+                    tree.insert(key, keys[i], session, finger);
+                } else {
+                    tree.insert(key, keys[i], session);
+                }
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+
+    auto threadInfo = tree.getThreadInfo();
+    for (auto k : keys) {
+        Key key;
+        loadKey(k, key);
+        if (tree.lookup(key, threadInfo) != k) {
+            std::cout << "wrong key read: " << k << std::endl;
+            throw;
+        }
+    }
+    auto stats = tree.collectStats(1);
+    printf("%s,%u,%s,%f,%f\n", name, threads, useFinger ? "yes" : "no", stats.getBytesPerKey(),
+           keys.size() / (duration.count() / 1000000.0) / 1000000.0);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n maxThreads\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned maxThreads = std::atoi(argv[2]);
+
+    std::vector<uint64_t> dense(n), sparse(n);
+    uint64_t timestamp = 1;
+    for (uint64_t i = 0; i < n; i++) {
+        dense[i] = i + 1;
+        timestamp += 1 + (i * 2654435761u) % 64;
+        sparse[i] = timestamp;
+    }
+
+    printf("keys,threads,append mode,bytes per key,Minserts/s\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        for (bool useFinger : {false, true}) {
+            run("dense", dense, threads, useFinger);
+            run("sparse", sparse, threads, useFinger);
+        }
+    }
+    return 0;
+}
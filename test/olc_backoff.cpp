@@ -0,0 +1,76 @@
+// Throughput of the ART_OLC backoff policies when many threads write to the same few nodes, which makes the
+// cache lines of their version locks bounce between cores and sockets.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. olc_backoff.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out hotKeys maxThreads seconds
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <random>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Backoff>
+double run(uint64_t hotKeys, unsigned threads, double seconds) {
+    ART_OLC::BasicTree<Backoff> tree(loadKey);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> ops{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto threadInfo = tree.getThreadInfo();
+            std::mt19937_64 rng(t);
+            // every thread owns the hot keys congruent to t, inserts of present keys are not supported
+            std::vector<bool> present(hotKeys / threads + 1);
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                uint64_t slot = rng() % present.size();
+                uint64_t k = slot * threads + t + 1;
+                Key key;
+                loadKey(k, key);
+                if (present[slot]) {
+                    tree.remove(key, k, threadInfo);
+                } else {
+                    tree.insert(key, k, threadInfo);
+                }
+                present[slot] = !present[slot];
+                tree.lookup(key, threadInfo);
+                done += 2;
+            }
+            ops += done;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &w : workers) {
+        w.join();
+    }
+    return ops / seconds;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s hotKeys maxThreads seconds\n", argv[0]);
+        return 1;
+    }
+    uint64_t hotKeys = std::atoll(argv[1]);
+    unsigned maxThreads = std::atoi(argv[2]);
+    double seconds = std::atof(argv[3]);
+
+    printf("backoff,threads,hotKeys,ops/s\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        printf("none,%u,%lu,%f\n", threads, hotKeys, run<ART_OLC::NoBackoff>(hotKeys, threads, seconds));
+        printf("pause,%u,%lu,%f\n", threads, hotKeys, run<ART_OLC::PauseSpin>(hotKeys, threads, seconds));
+        printf("exponential,%u,%lu,%f\n", threads, hotKeys,
+               run<ART_OLC::ExponentialBackoff>(hotKeys, threads, seconds));
+        printf("spinThenYield,%u,%lu,%f\n", threads, hotKeys, run<ART_OLC::SpinThenYield>(hotKeys, threads, seconds));
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Throughput of ART_OLC under write contention on a small hot key range.
+//
+// Build once as is and once with -DART_RESTART_FROM_ROOT to compare resuming restarts at the deepest
+// valid ancestor against restarting every operation at the root:
+//
+//     g++ -O3 -std=c++14 -march=native -I.. olc_contention.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out hotKeys maxThreads seconds
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <random>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+double run(ART_OLC::Tree &tree, uint64_t hotKeys, unsigned threads, double seconds) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> ops{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto threadInfo = tree.getThreadInfo();
+            std::mt19937_64 rng(t);
+            // every thread owns the hot keys congruent to t, inserts of present keys are not supported
+            std::vector<bool> present(hotKeys / threads + 1);
+            uint64_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                // hot keys share all upper levels and collide in the lowest nodes
+                uint64_t slot = rng() % present.size();
+                uint64_t k = slot * threads + t + 1;
+                Key key;
+                loadKey(k, key);
+                if (rng() % 2 == 0) {
+                    if (present[slot]) {
+                        tree.remove(key, k, threadInfo);
+                    } else {
+                        tree.insert(key, k, threadInfo);
+                    }
+                    present[slot] = !present[slot];
+                } else {
+                    tree.lookup(key, threadInfo);
+                }
+                done++;
+            }
+            ops += done;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &w : workers) {
+        w.join();
+    }
+    return ops / seconds;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s hotKeys maxThreads seconds\n", argv[0]);
+        return 1;
+    }
+    uint64_t hotKeys = std::atoll(argv[1]);
+    unsigned maxThreads = std::atoi(argv[2]);
+    double seconds = std::atof(argv[3]);
+
+#ifdef ART_RESTART_FROM_ROOT
+    const char *strategy = "root";
+#else
+    const char *strategy = "ancestor";
+#endif
+    printf("restart,threads,hotKeys,ops/s\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        ART_OLC::Tree tree(loadKey);
+        printf("%s,%u,%lu,%f\n", strategy, threads, hotKeys, run(tree, hotKeys, threads, seconds));
+    }
+    return 0;
+}
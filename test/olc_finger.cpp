@@ -0,0 +1,101 @@
+// Insert and lookup throughput of ART_OLC inside an EpocheSession with and without a Finger that resumes each
+// descent at the path of the previous operation of the thread. Every thread inserts and then looks up its own
+// range of the keys in order. The sorted keys are consecutive, the clustered keys take 16 consecutive values
+// every 4096 and the random keys are shuffled 63 bit integers.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. olc_finger.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n threads
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Fn>
+double parallel(unsigned threads, uint64_t operations, Fn fn) {
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return operations / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void run(const char *name, const std::vector<uint64_t> &keys, unsigned threads, bool useFinger) {
+    ART_OLC::Tree tree(loadKey);
+    std::size_t chunk = (keys.size() + threads - 1) / threads;
+    auto forRange = [&keys, chunk](unsigned t, const std::function<void(const Key &, uint64_t)> &fn) {
+        for (std::size_t i = t * chunk; i < std::min(keys.size(), (t + 1) * chunk); ++i) {
+            Key key;
+            loadKey(keys[i], key);
+            fn(key, keys[i]);
+        }
+    };
+    double inserts = parallel(threads, keys.size(), [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        EpocheSession session(threadInfo);
+        ART_OLC::Tree::Finger finger;
+        forRange(t, [&](const Key &key, uint64_t tid) {
+            if (useFinger) {
+                tree.insert(key, tid, session, finger);
+            } else {
+                tree.insert(key, tid, session);
+            }
+        });
+    });
+    double lookups = parallel(threads, keys.size(), [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        EpocheSession session(threadInfo);
+        ART_OLC::Tree::Finger finger;
+        forRange(t, [&](const Key &key, uint64_t tid) {
+            TID found = useFinger ? tree.lookup(key, session, finger) : tree.lookup(key, session);
+            if (found != tid) {
+                std::cout << "wrong key read: " << tid << std::endl;
+                throw;
+            }
+        });
+    });
+    printf("%s,%u,%s,%f,%f\n", name, threads, useFinger ? "yes" : "no", inserts, lookups);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n threads\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+
+    std::vector<uint64_t> sorted(n), clustered(n), random(n);
+    std::mt19937_64 rng(1);
+    for (uint64_t i = 0; i < n; i++) {
+        sorted[i] = i + 1;
+        clustered[i] = (i / 16) * 4096 + i % 16 + 1;
+        random[i] = rng() >> 1;
+    }
+    std::sort(random.begin(), random.end());
+    random.erase(std::unique(random.begin(), random.end()), random.end());
+    std::shuffle(random.begin(), random.end(), rng);
+
+    printf("keys,threads,finger,Minserts/s,Mlookups/s\n");
+    for (bool useFinger : {false, true}) {
+        run("sorted", sorted, threads, useFinger);
+        run("clustered", clustered, threads, useFinger);
+        run("random", random, threads, useFinger);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Remove and insert throughput of ART_OLC under churn with the three shrink policies. In the random walk every
+// bottom node has 28 possible keys of which a thread toggles random ones, so the nodes hover around 14 children
+// and cross the thresholds between N16 and N32 again and again. The queue inserts at its tail and removes at its
+// head, so the nodes at the head drain completely. With the lazy policy a final compact() shrinks the nodes,
+// its time and the bytes per key before and after it are reported.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. olc_shrink.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out nodes operations threads
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+const char *policyNames[] = {"eager", "hysteresis", "lazy"};
+
+template<typename Fn>
+double parallel(unsigned threads, uint64_t operations, Fn fn) {
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return operations / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void report(const char *name, ART_OLC::ShrinkPolicy policy, ART_OLC::Tree &tree, double throughput) {
+    auto threadInfo = tree.getThreadInfo();
+    double bytesPerKey = tree.collectStats(1).getBytesPerKey();
+    auto starttime = std::chrono::system_clock::now();
+    std::size_t compacted = tree.compact(threadInfo);
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    printf("%s,%s,%f,%f,%lu,%f,%f\n", name, policyNames[static_cast<unsigned>(policy)], throughput, bytesPerKey,
+           compacted, duration.count() / 1000.0, tree.collectStats(1).getBytesPerKey());
+}
+
+void randomWalk(ART_OLC::ShrinkPolicy policy, uint64_t nodes, uint64_t operations, unsigned threads) {
+    const uint64_t keysPerNode = 28;
+    ART_OLC::Tree tree(loadKey, ReclamationMode::Inline, NodeAllocator::Heap, ART_OLC::RootTable::None, policy);
+    {
+        auto threadInfo = tree.getThreadInfo();
+        for (uint64_t node = 0; node < nodes; ++node) {
+            for (uint64_t i = 0; i < keysPerNode; i += 2) {
+                Key key;
+                loadKey((node << 8) + i + 1, key);
+                tree.insert(key, (node << 8) + i + 1, threadInfo);
+            }
+        }
+    }
+    double throughput = parallel(threads, operations, [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        EpocheSession session(threadInfo);
+        std::mt19937_64 rng(t);
+        // the nodes of thread t
+        uint64_t begin = nodes * t / threads, end = nodes * (t + 1) / threads;
+        for (uint64_t i = 0; i < operations / threads; ++i) {
+            if (i % 4096 == 0) {
+                session.refresh();
+            }
+            uint64_t k = ((begin + rng() % (end - begin)) << 8) + rng() % keysPerNode + 1;
+            Key key;
+            loadKey(k, key);
+            if (tree.lookup(key, session) == k) {
+                tree.remove(key, k, session);
+            } else {
+                tree.insert(key, k, session);
+            }
+        }
+    });
+    report("random walk", policy, tree, throughput);
+}
+
+void queue(ART_OLC::ShrinkPolicy policy, uint64_t size, uint64_t operations, unsigned threads) {
+    ART_OLC::Tree tree(loadKey, ReclamationMode::Inline, NodeAllocator::Heap, ART_OLC::RootTable::None, policy);
+    {
+        auto threadInfo = tree.getThreadInfo();
+        for (uint64_t i = 1; i <= size; ++i) {
+            for (unsigned t = 0; t < threads; ++t) {
+                uint64_t k = (static_cast<uint64_t>(t) << 56) + i;
+                Key key;
+                loadKey(k, key);
+                tree.insert(key, k, threadInfo);
+            }
+        }
+    }
+    // every thread has its own queue
+    double throughput = parallel(threads, operations, [&](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        EpocheSession session(threadInfo);
+        for (uint64_t i = 1; i <= operations / threads / 2; ++i) {
+            if (i % 4096 == 0) {
+                session.refresh();
+            }
+            uint64_t head = (static_cast<uint64_t>(t) << 56) + i;
+            Key key;
+            loadKey(head, key);
+            tree.remove(key, head, session);
+            loadKey(head + size, key);
+            tree.insert(key, head + size, session);
+        }
+    });
+    report("queue", policy, tree, throughput);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        printf("usage: %s nodes operations threads\n", argv[0]);
+        return 1;
+    }
+    uint64_t nodes = std::atoll(argv[1]);
+    uint64_t operations = std::atoll(argv[2]);
+    unsigned threads = std::atoi(argv[3]);
+
+    printf("workload,shrink policy,Mops/s,bytes per key,compacted nodes,compact ms,bytes per key after compact\n");
+    for (auto policy : {ART_OLC::ShrinkPolicy::Eager, ART_OLC::ShrinkPolicy::Hysteresis, ART_OLC::ShrinkPolicy::Lazy}) {
+        randomWalk(policy, nodes, operations, threads);
+    }
+    for (auto policy : {ART_OLC::ShrinkPolicy::Eager, ART_OLC::ShrinkPolicy::Hysteresis, ART_OLC::ShrinkPolicy::Lazy}) {
+        queue(policy, nodes * 14, operations, threads);
+    }
+    return 0;
+}
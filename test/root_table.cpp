@@ -0,0 +1,90 @@
+// Insert and lookup throughput of ART_OLC with an N256 root and with a root table of 256 and 65536 slots for
+// random 63 bit keys, which spread over all slots. The inserts of all threads start in the same root node or in
+// the slots of their keys.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. root_table.cpp ../OptimisticLockCoupling/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n maxThreads
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+
+// a moved tree would share the slots with the tree it was moved from, which frees them
+static_assert(!std::is_move_constructible<ART_OLC::Tree>::value, "the root table cannot be moved");
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Fn>
+double parallel(unsigned threads, uint64_t operations, Fn fn) {
+    auto starttime = std::chrono::system_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now() - starttime);
+    return operations / (duration.count() / 1000000.0) / 1000000.0;
+}
+
+void run(const char *name, ART_OLC::RootTable rootTable, const std::vector<uint64_t> &keys, unsigned threads) {
+    ART_OLC::Tree tree(loadKey, ReclamationMode::Inline, NodeAllocator::Heap, rootTable);
+    double inserts = parallel(threads, keys.size(), [&tree, &keys, threads](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        for (std::size_t i = t; i < keys.size(); i += threads) {
+            Key key;
+            loadKey(keys[i], key);
+            tree.insert(key, keys[i], threadInfo);
+        }
+    });
+    double lookups = parallel(threads, keys.size(), [&tree, &keys, threads](unsigned t) {
+        auto threadInfo = tree.getThreadInfo();
+        for (std::size_t i = t; i < keys.size(); i += threads) {
+            Key key;
+            loadKey(keys[i], key);
+            if (tree.lookup(key, threadInfo) != keys[i]) {
+                std::cout << "wrong key read: " << keys[i] << std::endl;
+                throw;
+            }
+        }
+    });
+    auto stats = tree.collectStats();
+    printf("%s,%u,%f,%f,%f,%f\n", name, threads, stats.getBytesPerKey(), stats.getAverageLeafDepth(), inserts,
+           lookups);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n maxThreads\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned maxThreads = std::atoi(argv[2]);
+
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = rng() >> 1;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    printf("root,threads,bytes per key,average leaf depth,Minserts/s,Mlookups/s\n");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        run("N256", ART_OLC::RootTable::None, keys, threads);
+        run("256 slots", ART_OLC::RootTable::OneByte, keys, threads);
+        run("65536 slots", ART_OLC::RootTable::TwoBytes, keys, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Bytes per key, average leaf depth and lookup throughput of the unsynchronized tree after a bulkload that may
+// replace a node and its inner children with one N65536 where that costs at most maxSpanOverhead times their bytes,
+// 0 builds one key byte per level. The dense keys take all 65536 values in their second and third byte. A dataset
+// in the SOSD format (8 byte count, then the 64 bit keys) can be given instead of the generated keys, the keys are
+// shifted right by one bit to stay below the leaf bit.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. span_nodes.cpp ../ART/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n lookups [sosd file]
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <vector>
+#include "../ART/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+std::vector<uint64_t> unique(std::vector<uint64_t> keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+std::vector<uint64_t> generateDense(uint64_t n) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = static_cast<uint64_t>(1) << 56 | (rng() & 0xffffffffffffff);
+    }
+    return unique(keys);
+}
+
+std::vector<uint64_t> generateSparse(uint64_t n) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto &k : keys) {
+        k = rng() >> 1;
+    }
+    return unique(keys);
+}
+
+std::vector<uint64_t> readSosd(const char *file, uint64_t n) {
+    std::ifstream in(file, std::ios::binary);
+    uint64_t size = 0;
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    std::vector<uint64_t> keys(std::min(size, n));
+    in.read(reinterpret_cast<char *>(keys.data()), keys.size() * sizeof(uint64_t));
+    for (auto &k : keys) {
+        k = (k >> 1) | 1;
+    }
+    return unique(keys);
+}
+
+void run(const char *name, const std::vector<uint64_t> &keys, uint64_t lookups) {
+    std::vector<std::pair<Key, TID>> pairs(keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        loadKey(keys[i], pairs[i].first);
+        pairs[i].second = keys[i];
+    }
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> order(lookups);
+    for (auto &k : order) {
+        k = keys[rng() % keys.size()];
+    }
+    for (double maxSpanOverhead : {0.0, 1.0, 2.0}) {
+        ART_unsynchronized::Tree tree(loadKey);
+        tree.bulkload(pairs, maxSpanOverhead);
+        auto starttime = std::chrono::system_clock::now();
+        for (auto k : order) {
+            Key key;
+            loadKey(k, key);
+            if (tree.lookup(key) != k) {
+                std::cout << "wrong key read: " << k << std::endl;
+                throw;
+            }
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now() - starttime);
+        auto stats = tree.collectStats(1);
+        printf("%s,%.1f,%lu,%f,%f,%f\n", name, maxSpanOverhead, stats.nodes[5], stats.getBytesPerKey(),
+               stats.getAverageLeafDepth(), lookups / (duration.count() / 1000000.0) / 1000000.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 4) {
+        printf("usage: %s n lookups [sosd file]\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    uint64_t lookups = std::atoll(argv[2]);
+
+    printf("keys,max span overhead,N65536 nodes,bytes per key,average leaf depth,Mlookups/s\n");
+    if (argc == 4) {
+        run(argv[3], readSosd(argv[3], n), lookups);
+        return 0;
+    }
+    run("dense", generateDense(n), lookups);
+    run("sparse", generateSparse(n), lookups);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Structural statistics of the three trees for dense, sparse and random keys and the time it takes to
+// collect them with one thread compared to several.
+//
+//     g++ -O3 -std=c++14 -march=native -I.. tree_stats.cpp ../OptimisticLockCoupling/Tree.cpp ../ROWEX/Tree.cpp ../ART/Tree.cpp -ltbb -lpthread
+//
+//     ./a.out n threads
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../OptimisticLockCoupling/Tree.h"
+#include "../ROWEX/Tree.h"
+#include "../ART/Tree.h"
+
+void loadKey(TID tid, Key &key) {
+    key.setKeyLen(sizeof(tid));
+    reinterpret_cast<uint64_t *>(&key[0])[0] = __builtin_bswap64(tid);
+}
+
+template<typename Tree>
+void report(const char *name, const char *keys, const Tree &tree, unsigned threads) {
+    auto measure = [&tree](unsigned t) {
+        auto starttime = std::chrono::system_clock::now();
+        auto stats = tree.collectStats(t);
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now() - starttime);
+        return std::make_pair(stats, duration.count());
+    };
+    auto single = measure(1);
+    auto parallel = measure(threads);
+    std::cout << "== " << name << ", " << keys << " keys, collected in " << single.second << "us with 1 thread, "
+              << parallel.second << "us with " << threads << std::endl;
+    parallel.first.print(std::cout);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s n threads\n", argv[0]);
+        return 1;
+    }
+    uint64_t n = std::atoll(argv[1]);
+    unsigned threads = std::atoi(argv[2]);
+
+    std::mt19937_64 rng(42);
+    std::vector<std::pair<const char *, std::vector<uint64_t>>> datasets(3);
+    datasets[0].first = "dense";
+    datasets[1].first = "sparse";
+    datasets[2].first = "random";
+    for (uint64_t i = 1; i <= n; i++) {
+        datasets[0].second.push_back(i);
+        datasets[1].second.push_back(i << 20);
+        // stays below the leaf bit
+        datasets[2].second.push_back(rng() >> 1);
+    }
+
+    for (auto &dataset : datasets) {
+        {
+            ART_OLC::Tree tree(loadKey);
+            auto t = tree.getThreadInfo();
+            for (auto k : dataset.second) {
+                Key key;
+                loadKey(k, key);
+                tree.insert(key, k, t);
+            }
+            report("olc", dataset.first, tree, threads);
+        }
+        {
+            ART_ROWEX::Tree tree(loadKey);
+            auto t = tree.getThreadInfo();
+            for (auto k : dataset.second) {
+                Key key;
+                loadKey(k, key);
+                tree.insert(key, k, t);
+            }
+            report("rowex", dataset.first, tree, threads);
+        }
+        {
+            ART_unsynchronized::Tree tree(loadKey);
+            for (auto k : dataset.second) {
+                Key key;
+                loadKey(k, key);
+                tree.insert(key, k);
+            }
+            report("unsynchronized", dataset.first, tree, threads);
+        }
+    }
+    return 0;
+}